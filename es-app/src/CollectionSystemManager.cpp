@@ -252,7 +252,11 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 			// if we found it, we need to update it
 			FileData* collectionEntry = children.at(key);
 			// remove from index, so we can re-index metadata after refreshing
+			// custom collections shown in the bundle have their entries in its index too
+			SystemData* systemViewToUpdate = getSystemToView(curSys);
 			fileIndex->removeFromIndex(collectionEntry);
+			if(systemViewToUpdate != curSys)
+				systemViewToUpdate->getIndex()->removeFromIndex(collectionEntry);
 			collectionEntry->refreshMetadata();
 			// found and we are removing
 			if (name == "favorites" && file->metadata.get("favorite") == "false") {
@@ -263,6 +267,8 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 			{
 				// re-index with new metadata
 				fileIndex->addToIndex(collectionEntry);
+				if(systemViewToUpdate != curSys)
+					systemViewToUpdate->getIndex()->addToIndex(collectionEntry);
 				ViewController::get()->onFileChanged(collectionEntry, FILE_METADATA_CHANGED);
 			}
 		}
@@ -508,8 +514,10 @@ bool CollectionSystemManager::toggleGameInCollection(FileData* file)
 		}
 		else
 		{
-			file->getSourceFileData()->getSystem()->getIndex()->removeFromIndex(file);
-			MetaDataList* md = &file->getSourceFileData()->metadata;
+			// the source game is the one in its system's index, collection entries are re-indexed by refreshCollectionSystems
+			FileData* sourceFile = file->getSourceFileData();
+			sourceFile->getSystem()->getIndex()->removeFromIndex(sourceFile);
+			MetaDataList* md = &sourceFile->metadata;
 			std::string value = md->get("favorite");
 			if (value == "false")
 			{
@@ -520,8 +528,8 @@ bool CollectionSystemManager::toggleGameInCollection(FileData* file)
 				adding = false;
 				md->set("favorite", "false");
 			}
-			file->getSourceFileData()->getSystem()->getIndex()->addToIndex(file);
-			refreshCollectionSystems(file->getSourceFileData());
+			sourceFile->getSystem()->getIndex()->addToIndex(sourceFile);
+			refreshCollectionSystems(sourceFile);
 		}
 		if (adding)
 		{
@@ -674,6 +682,7 @@ SystemData* CollectionSystemManager::addNewCustomCollection(std::string name)
 SystemData* CollectionSystemManager::createNewCollectionEntry(std::string name, CollectionSystemDecl sysDecl, bool index)
 {
 	SystemData* newSys = new SystemData(name, sysDecl.longName, mCollectionEnvData, sysDecl.themeFolder, true);
+	newSys->loadTheme();
 
 	CollectionSystemData newCollectionData;
 	newCollectionData.system = newSys;
@@ -2,6 +2,7 @@
 
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
+#include "utils/ThreadPool.h"
 #include "utils/TimeUtil.h"
 #include "AudioManager.h"
 #include "CollectionSystemManager.h"
@@ -9,18 +10,62 @@
 #include "FileSorts.h"
 #include "Log.h"
 #include "MameNames.h"
+#include "MediaIndex.h"
 #include "platform.h"
 #include "SystemData.h"
 #include "VolumeControl.h"
 #include "Window.h"
 #include <assert.h>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <unordered_set>
+
+typedef std::unordered_set<std::string> FileNameSet;
+
+// The file names in each system's images folder, listed once instead of stat'ing every game's candidate files.
+// Systems are loaded on several threads, so a listing is made under the lock and only read after that.
+static std::mutex												sImageFoldersMutex;
+static std::map<std::string, std::shared_ptr<const FileNameSet> >	sImageFolders;
+
+// The name a file is listed and looked up by. Windows and macOS file systems ignore case, so the names are compared that way too.
+static std::string getImageFolderKey(const std::string& name)
+{
+#if defined (WIN32) || defined (__APPLE__)
+	return Utils::String::toLower(name);
+#else
+	return name;
+#endif
+}
+
+static std::shared_ptr<const FileNameSet> getImageFolder(const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(sImageFoldersMutex);
+
+	auto it = sImageFolders.find(path);
+	if(it != sImageFolders.cend())
+		return it->second;
+
+	std::shared_ptr<FileNameSet> names = std::make_shared<FileNameSet>();
+	Utils::FileSystem::stringList content = Utils::FileSystem::getDirContent(path);
+	for(auto contentIt = content.cbegin(); contentIt != content.cend(); contentIt++)
+		names->insert(getImageFolderKey(Utils::FileSystem::getFileName(*contentIt)));
+
+	sImageFolders[path] = names;
+	return names;
+}
 
 FileData::FileData(FileType type, const std::string& path, SystemEnvironmentData* envData, SystemData* system)
-	: mType(type), mPath(path), mSystem(system), mEnvData(envData), mSourceFileData(NULL), mParent(NULL), metadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
+	: mType(type), mPath(path), mSystem(system), mEnvData(envData), mSourceFileData(NULL), mParent(NULL), mFilteredIndex(NULL), mFilteredGeneration(0), metadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
 {
+	// the MAME name lookup is only done once, views ask for the display name on every cursor change
+	mDisplayName = Utils::FileSystem::getStem(mPath);
+	if(mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE) || mSystem->hasPlatformId(PlatformIds::NEOGEO))
+		mDisplayName = MameNames::getInstance()->getRealName(mDisplayName);
+
 	// metadata needs at least a name field (since that's what getName() will return)
-	if(metadata.get("name").empty())
-		metadata.set("name", getDisplayName());
+	if(metadata.get(MD_ID_NAME).empty())
+		metadata.set(MD_ID_NAME, getDisplayName());
 	mSystemName = system->getName();
 }
 
@@ -30,20 +75,14 @@ FileData::~FileData()
 		mParent->removeChild(this);
 
 	if(mType == GAME)
+	{
 		mSystem->getIndex()->removeFromIndex(this);
+		MediaIndex::getInstance()->remove(this);
+	}
 
 	mChildren.clear();
 }
 
-std::string FileData::getDisplayName() const
-{
-	std::string stem = Utils::FileSystem::getStem(mPath);
-	if(mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE) || mSystem->hasPlatformId(PlatformIds::NEOGEO))
-		stem = MameNames::getInstance()->getRealName(stem);
-
-	return stem;
-}
-
 std::string FileData::getCleanName() const
 {
 	return Utils::String::removeParenthesis(this->getDisplayName());
@@ -51,27 +90,16 @@ std::string FileData::getCleanName() const
 
 const std::string FileData::getThumbnailPath() const
 {
-	std::string thumbnail = metadata.get("thumbnail");
+	std::string thumbnail = metadata.get(MD_ID_THUMBNAIL);
 
 	// no thumbnail, try image
 	if(thumbnail.empty())
 	{
-		thumbnail = metadata.get("image");
+		thumbnail = metadata.get(MD_ID_IMAGE);
 
 		// no image, try to use local image
 		if(thumbnail.empty())
-		{
-			const char* extList[2] = { ".png", ".jpg" };
-			for(int i = 0; i < 2; i++)
-			{
-				if(thumbnail.empty())
-				{
-					std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-image" + extList[i];
-					if(Utils::FileSystem::exists(path))
-						thumbnail = path;
-				}
-			}
-		}
+			thumbnail = getLocalMedia().image;
 	}
 
 	return thumbnail;
@@ -79,13 +107,19 @@ const std::string FileData::getThumbnailPath() const
 
 const std::string& FileData::getName()
 {
-	return metadata.get("name");
+	return metadata.get(MD_ID_NAME);
 }
 
 const std::vector<FileData*>& FileData::getChildrenListToDisplay() {
 
 	FileFilterIndex* idx = CollectionSystemManager::get()->getSystemToView(mSystem)->getIndex();
 	if (idx->isFiltered()) {
+		// the list stays valid until a filter, an index or the children of any folder change
+		if (mFilteredIndex == idx && mFilteredGeneration == FileFilterIndex::getGeneration())
+			return mFilteredChildren;
+
+		mFilteredIndex = idx;
+		mFilteredGeneration = FileFilterIndex::getGeneration();
 		mFilteredChildren.clear();
 		for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
 		{
@@ -104,61 +138,64 @@ const std::vector<FileData*>& FileData::getChildrenListToDisplay() {
 
 const std::string FileData::getVideoPath() const
 {
-	std::string video = metadata.get("video");
+	std::string video = metadata.get(MD_ID_VIDEO);
 
 	// no video, try to use local video
 	if(video.empty())
-	{
-		std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-video.mp4";
-		if(Utils::FileSystem::exists(path))
-			video = path;
-	}
+		video = getLocalMedia().video;
 
 	return video;
 }
 
 const std::string FileData::getMarqueePath() const
 {
-	std::string marquee = metadata.get("marquee");
+	std::string marquee = metadata.get(MD_ID_MARQUEE);
 
 	// no marquee, try to use local marquee
 	if(marquee.empty())
-	{
-		const char* extList[2] = { ".png", ".jpg" };
-		for(int i = 0; i < 2; i++)
-		{
-			if(marquee.empty())
-			{
-				std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-marquee" + extList[i];
-				if(Utils::FileSystem::exists(path))
-					marquee = path;
-			}
-		}
-	}
+		marquee = getLocalMedia().marquee;
 
 	return marquee;
 }
 
 const std::string FileData::getImagePath() const
 {
-	std::string image = metadata.get("image");
+	std::string image = metadata.get(MD_ID_IMAGE);
 
 	// no image, try to use local image
 	if(image.empty())
+		image = getLocalMedia().image;
+
+	return image;
+}
+
+const FileData::LocalMedia& FileData::getLocalMedia() const
+{
+	if(!mLocalMedia)
 	{
+		const std::string folder = mEnvData->mStartPath + "/images";
+		std::shared_ptr<const FileNameSet> names = getImageFolder(folder);
+
+		mLocalMedia = std::unique_ptr<LocalMedia>(new LocalMedia());
+
 		const char* extList[2] = { ".png", ".jpg" };
 		for(int i = 0; i < 2; i++)
 		{
-			if(image.empty())
-			{
-				std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-image" + extList[i];
-				if(Utils::FileSystem::exists(path))
-					image = path;
-			}
+			const std::string image = mDisplayName + "-image" + extList[i];
+			if(mLocalMedia->image.empty() && names->count(getImageFolderKey(image)))
+				mLocalMedia->image = folder + "/" + image;
+
+			const std::string marquee = mDisplayName + "-marquee" + extList[i];
+			if(mLocalMedia->marquee.empty() && names->count(getImageFolderKey(marquee)))
+				mLocalMedia->marquee = folder + "/" + marquee;
 		}
+
+		const std::string video = mDisplayName + "-video.mp4";
+		if(names->count(getImageFolderKey(video)))
+			mLocalMedia->video = folder + "/" + video;
 	}
 
-	return image;
+	return *mLocalMedia;
 }
 
 std::vector<FileData*> FileData::getFilesRecursive(unsigned int typeMask, bool displayedOnly) const
@@ -204,6 +241,7 @@ void FileData::addChild(FileData* file)
 		mChildrenByFilename[key] = file;
 		mChildren.push_back(file);
 		file->mParent = this;
+		FileFilterIndex::invalidate();
 	}
 }
 
@@ -218,6 +256,7 @@ void FileData::removeChild(FileData* file)
 		{
 			file->mParent = NULL;
 			mChildren.erase(it);
+			FileFilterIndex::invalidate();
 			return;
 		}
 	}
@@ -239,11 +278,161 @@ void FileData::sort(ComparisonFunction& comparator, bool ascending)
 
 	if(!ascending)
 		std::reverse(mChildren.begin(), mChildren.end());
+
+	FileFilterIndex::invalidate();
 }
 
+// below this many files sorting is quicker than handing it to the sort pool
+#define PARALLEL_SORT_THRESHOLD 4096
+
+// Shared by every sort and only started by the first large one. Systems are sorted on the loader's threads,
+// a pool per sort would start a thread per core for each of them.
+static Utils::ThreadPool& getSortPool()
+{
+	static Utils::ThreadPool pool;
+	return pool;
+}
+
+// The work one sort queued on the sort pool, so it only waits for its own work and not that of the other sorts
+class SortBatch
+{
+public:
+	SortBatch() : mPending(0) { }
+
+	void queueWorkItem(const std::function<void()>& work)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			++mPending;
+		}
+
+		getSortPool().queueWorkItem([this, work]
+		{
+			work();
+
+			// notified with the lock held, once it's released the waiting sort may already be gone
+			std::unique_lock<std::mutex> lock(mMutex);
+			--mPending;
+			mDone.notify_all();
+		});
+	}
+
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDone.wait(lock, [this] { return mPending == 0; });
+	}
+
+	int getThreadCount() const { return getSortPool().getThreadCount(); }
+
+private:
+	std::mutex				mMutex;
+	std::condition_variable	mDone;
+	int						mPending;
+};
+
 void FileData::sort(const SortType& type)
 {
-	sort(*type.comparisonFunction, type.ascending);
+	if(type.keyFunction == NULL)
+	{
+		sort(*type.comparisonFunction, type.ascending);
+		return;
+	}
+
+	// every folder is sorted independently, so gather them all first
+	std::vector<FileData*> folders;
+	size_t fileCount = 0;
+	folders.push_back(this);
+	for(size_t i = 0; i < folders.size(); i++)
+	{
+		const std::vector<FileData*>& children = folders[i]->mChildren;
+		fileCount += children.size();
+
+		for(auto it = children.cbegin(); it != children.cend(); it++)
+		{
+			if((*it)->mChildren.size() > 0)
+				folders.push_back(*it);
+		}
+	}
+
+	if(fileCount < PARALLEL_SORT_THRESHOLD)
+	{
+		for(auto it = folders.cbegin(); it != folders.cend(); it++)
+			(*it)->sortChildren(type, NULL);
+
+		return;
+	}
+
+	SortBatch batch;
+
+	// large folders spread their own sort over the pool, the others get sorted one per task
+	for(auto it = folders.cbegin(); it != folders.cend(); it++)
+	{
+		if((*it)->mChildren.size() >= PARALLEL_SORT_THRESHOLD)
+			(*it)->sortChildren(type, &batch);
+	}
+
+	for(auto it = folders.cbegin(); it != folders.cend(); it++)
+	{
+		FileData* folder = *it;
+		if(folder->mChildren.size() < PARALLEL_SORT_THRESHOLD)
+			batch.queueWorkItem([folder, &type] { folder->sortChildren(type, NULL); });
+	}
+
+	batch.wait();
+}
+
+void FileData::sortChildren(const SortType& type, SortBatch* batch)
+{
+	const int count = (int)mChildren.size();
+
+	std::vector<SortKey> keys(count);
+	std::vector<int> order(count);
+	for(int i = 0; i < count; i++)
+	{
+		type.keyFunction(mChildren[i], keys[i]);
+		order[i] = i;
+	}
+
+	auto compare = [&keys](int a, int b) { return keys[a] < keys[b]; };
+
+	if(batch == NULL)
+	{
+		std::stable_sort(order.begin(), order.end(), compare);
+	}
+	else
+	{
+		// sort one chunk per thread, then merge neighbouring chunks until a single one is left
+		const int chunkSize = (count + batch->getThreadCount() - 1) / batch->getThreadCount();
+		for(int start = 0; start < count; start += chunkSize)
+		{
+			const int end = std::min(start + chunkSize, count);
+			batch->queueWorkItem([&order, &compare, start, end] { std::stable_sort(order.begin() + start, order.begin() + end, compare); });
+		}
+		batch->wait();
+
+		for(int width = chunkSize; width < count; width *= 2)
+		{
+			for(int start = 0; start + width < count; start += width * 2)
+			{
+				const int middle = start + width;
+				const int end    = std::min(start + width * 2, count);
+				batch->queueWorkItem([&order, &compare, start, middle, end] { std::inplace_merge(order.begin() + start, order.begin() + middle, order.begin() + end, compare); });
+			}
+			batch->wait();
+		}
+	}
+
+	std::vector<FileData*> sorted(count);
+	for(int i = 0; i < count; i++)
+		sorted[i] = mChildren[order[i]];
+
+	// same as the comparator based sort, descending is the reversed stable ascending order
+	if(!type.ascending)
+		std::reverse(sorted.begin(), sorted.end());
+
+	mChildren.swap(sorted);
+	FileFilterIndex::invalidate();
 }
 
 void FileData::launchGame(Window* window)
@@ -280,11 +469,11 @@ void FileData::launchGame(Window* window)
 
 	FileData* gameToUpdate = getSourceFileData();
 
-	int timesPlayed = gameToUpdate->metadata.getInt("playcount") + 1;
-	gameToUpdate->metadata.set("playcount", std::to_string(static_cast<long long>(timesPlayed)));
+	int timesPlayed = gameToUpdate->metadata.getInt(MD_ID_PLAYCOUNT) + 1;
+	gameToUpdate->metadata.set(MD_ID_PLAYCOUNT, std::to_string(static_cast<long long>(timesPlayed)));
 
 	//update last played time
-	gameToUpdate->metadata.set("lastplayed", Utils::Time::DateTime(Utils::Time::now()));
+	gameToUpdate->metadata.set(MD_ID_LASTPLAYED, Utils::Time::DateTime(Utils::Time::now()));
 	CollectionSystemManager::get()->refreshCollectionSystems(gameToUpdate);
 }
 
@@ -325,7 +514,7 @@ void CollectionFileData::refreshMetadata()
 const std::string& CollectionFileData::getName()
 {
 	if (mDirty) {
-		mCollectionFileName  = Utils::String::removeParenthesis(mSourceFileData->metadata.get("name"));
+		mCollectionFileName  = Utils::String::removeParenthesis(mSourceFileData->metadata.get(MD_ID_NAME));
 		mCollectionFileName += " [" + Utils::String::toUpper(mSourceFileData->getSystem()->getName()) + "]";
 		mDirty = false;
 	}
@@ -334,7 +523,6 @@ const std::string& CollectionFileData::getName()
 
 // returns Sort Type based on a string description
 FileData::SortType getSortTypeFromString(std::string desc) {
-	std::vector<FileData::SortType> SortTypes = FileSorts::SortTypes;
 	// find it
 	for(unsigned int i = 0; i < FileSorts::SortTypes.size(); i++)
 	{
@@ -4,11 +4,14 @@
 
 #include "utils/FileSystemUtil.h"
 #include "MetaData.h"
+#include <memory>
 #include <unordered_map>
 
+class FileFilterIndex;
 class SystemData;
 class Window;
 struct SystemEnvironmentData;
+class SortBatch;
 
 enum FileType
 {
@@ -66,7 +69,7 @@ public:
 	inline std::string getSystemName() const { return mSystemName; };
 
 	// Returns our best guess at the "real" name for this file (will attempt to perform MAME name translation)
-	std::string getDisplayName() const;
+	inline const std::string& getDisplayName() const { return mDisplayName; }
 
 	// As above, but also remove parenthesis
 	std::string getCleanName() const;
@@ -74,18 +77,30 @@ public:
 	void launchGame(Window* window);
 
 	typedef bool ComparisonFunction(const FileData* a, const FileData* b);
+
+	// The value a file is ordered by, computed once per sort instead of once per comparison.
+	struct SortKey
+	{
+		double number;
+		std::string text;
+
+		inline bool operator<(const SortKey& other) const { return (number < other.number) || ((number == other.number) && (text < other.text)); }
+	};
+	typedef void SortKeyFunction(const FileData* file, SortKey& key);
+
 	struct SortType
 	{
 		ComparisonFunction* comparisonFunction;
+		SortKeyFunction* keyFunction; // must order files the same way as comparisonFunction
 		bool ascending;
 		std::string description;
 
-		SortType(ComparisonFunction* sortFunction, bool sortAscending, const std::string & sortDescription)
-			: comparisonFunction(sortFunction), ascending(sortAscending), description(sortDescription) {}
+		SortType(ComparisonFunction* sortFunction, SortKeyFunction* sortKeyFunction, bool sortAscending, const std::string & sortDescription)
+			: comparisonFunction(sortFunction), keyFunction(sortKeyFunction), ascending(sortAscending), description(sortDescription) {}
 	};
 
 	void sort(ComparisonFunction& comparator, bool ascending = true);
-	void sort(const SortType& type);
+	void sort(const SortType& type); // also sorts every folder below this one, large trees are sorted on several threads
 	MetaDataList metadata;
 
 protected:
@@ -94,13 +109,30 @@ protected:
 	std::string mSystemName;
 
 private:
+	// Media in the system's images folder named after the display name, the fallback when the metadata has none
+	struct LocalMedia
+	{
+		std::string image;
+		std::string video;
+		std::string marquee;
+	};
+
+	// looked up the first time any of it is asked for, it doesn't depend on the metadata
+	const LocalMedia& getLocalMedia() const;
+
 	FileType mType;
 	std::string mPath;
+	std::string mDisplayName;
+	mutable std::unique_ptr<LocalMedia> mLocalMedia;
 	SystemEnvironmentData* mEnvData;
 	SystemData* mSystem;
 	std::unordered_map<std::string,FileData*> mChildrenByFilename;
 	std::vector<FileData*> mChildren;
 	std::vector<FileData*> mFilteredChildren;
+	FileFilterIndex* mFilteredIndex; // index and generation mFilteredChildren was built for
+	unsigned int mFilteredGeneration;
+
+	void sortChildren(const SortType& type, SortBatch* batch);
 };
 
 class CollectionFileData : public FileData
@@ -5,12 +5,15 @@
 #include "FileData.h"
 #include "Log.h"
 #include "Settings.h"
+#include <algorithm>
 
 #define UNKNOWN_LABEL "UNKNOWN"
 #define INCLUDE_UNKNOWN false;
 
+std::atomic<unsigned int> FileFilterIndex::sGeneration(1);
+
 FileFilterIndex::FileFilterIndex()
-	: filterByFavorites(false), filterByGenre(false), filterByHidden(false), filterByKidGame(false), filterByPlayers(false), filterByPubDev(false), filterByRatings(false)
+	: mShownGamesDirty(true), filterByFavorites(false), filterByGenre(false), filterByHidden(false), filterByKidGame(false), filterByPlayers(false), filterByPubDev(false), filterByRatings(false)
 {
 	clearAllFilters();
 	FilterDataDecl filterDecls[] = {
@@ -83,6 +86,14 @@ void FileFilterIndex::resetIndex()
 	clearIndex(favoritesIndexAllKeys);
 	clearIndex(hiddenIndexAllKeys);
 	clearIndex(kidGameIndexAllKeys);
+
+	mGameSlots.clear();
+	mFreeSlots.clear();
+	mSlotKeys.clear();
+	for (int type = 0; type <= KIDGAME_FILTER; type++)
+		mGamesByKey[type].clear();
+	mShownGames.clear();
+	mShownGamesDirty = true;
 }
 
 std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType type, bool getSecondary)
@@ -92,7 +103,7 @@ std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType typ
 	{
 		case GENRE_FILTER:
 		{
-			key = Utils::String::toUpper(game->metadata.get("genre"));
+			key = Utils::String::toUpper(game->metadata.get(MD_ID_GENRE));
 			key = Utils::String::trim(key);
 			if (getSecondary && !key.empty()) {
 				std::istringstream f(key);
@@ -114,18 +125,18 @@ std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType typ
 			if (getSecondary)
 				break;
 
-			key = game->metadata.get("players");
+			key = game->metadata.get(MD_ID_PLAYERS);
 			break;
 		}
 		case PUBDEV_FILTER:
 		{
-			key = Utils::String::toUpper(game->metadata.get("publisher"));
+			key = Utils::String::toUpper(game->metadata.get(MD_ID_PUBLISHER));
 			key = Utils::String::trim(key);
 
 			if ((getSecondary && !key.empty()) || (!getSecondary && key.empty()))
-				key = Utils::String::toUpper(game->metadata.get("developer"));
+				key = Utils::String::toUpper(game->metadata.get(MD_ID_DEVELOPER));
 			else
-				key = Utils::String::toUpper(game->metadata.get("publisher"));
+				key = Utils::String::toUpper(game->metadata.get(MD_ID_PUBLISHER));
 			break;
 		}
 		case RATINGS_FILTER:
@@ -133,7 +144,7 @@ std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType typ
 			int ratingNumber = 0;
 			if (!getSecondary)
 			{
-				std::string ratingString = game->metadata.get("rating");
+				std::string ratingString = game->metadata.get(MD_ID_RATING);
 				if (!ratingString.empty()) {
 					try {
 						ratingNumber = (int)((std::stod(ratingString)*5)+0.5);
@@ -154,21 +165,21 @@ std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType typ
 		{
 			if (game->getType() != GAME)
 				return "FALSE";
-			key = Utils::String::toUpper(game->metadata.get("favorite"));
+			key = Utils::String::toUpper(game->metadata.get(MD_ID_FAVORITE));
 			break;
 		}
 		case HIDDEN_FILTER:
 		{
 			if (game->getType() != GAME)
 				return "FALSE";
-			key = Utils::String::toUpper(game->metadata.get("hidden"));
+			key = Utils::String::toUpper(game->metadata.get(MD_ID_HIDDEN));
 			break;
 		}
 		case KIDGAME_FILTER:
 		{
 			if (game->getType() != GAME)
 				return "FALSE";
-			key = Utils::String::toUpper(game->metadata.get("kidgame"));
+			key = Utils::String::toUpper(game->metadata.get(MD_ID_KIDGAME));
 			break;
 		}
 	}
@@ -181,6 +192,8 @@ std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType typ
 
 void FileFilterIndex::addToIndex(FileData* game)
 {
+	addGameBits(game);
+
 	manageGenreEntryInIndex(game);
 	managePlayerEntryInIndex(game);
 	managePubDevEntryInIndex(game);
@@ -192,6 +205,8 @@ void FileFilterIndex::addToIndex(FileData* game)
 
 void FileFilterIndex::removeFromIndex(FileData* game)
 {
+	removeGameBits(game);
+
 	manageGenreEntryInIndex(game, true);
 	managePlayerEntryInIndex(game, true);
 	managePubDevEntryInIndex(game, true);
@@ -213,7 +228,7 @@ void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>*
 		for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it ) {
 			if ((*it).type == type)
 			{
-				FilterDataDecl filterData = (*it);
+				const FilterDataDecl& filterData = (*it);
 				*(filterData.filteredByRef) = values->size() > 0;
 				filterData.currentFilteredKeys->clear();
 				for (std::vector<std::string>::const_iterator vit = values->cbegin(); vit != values->cend(); ++vit ) {
@@ -225,6 +240,9 @@ void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>*
 			}
 		}
 	}
+
+	mShownGamesDirty = true;
+	invalidate();
 	return;
 }
 
@@ -232,10 +250,13 @@ void FileFilterIndex::clearAllFilters()
 {
 	for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it )
 	{
-		FilterDataDecl filterData = (*it);
+		const FilterDataDecl& filterData = (*it);
 		*(filterData.filteredByRef) = false;
 		filterData.currentFilteredKeys->clear();
 	}
+
+	mShownGamesDirty = true;
+	invalidate();
 	return;
 }
 
@@ -296,7 +317,7 @@ bool FileFilterIndex::showFile(FileData* game)
 	// if folder, needs further inspection - i.e. see if folder contains at least one element
 	// that should be shown
 	if (game->getType() == FOLDER) {
-		std::vector<FileData*> children = game->getChildren();
+		const std::vector<FileData*>& children = game->getChildren();
 		// iterate through all of the children, until there's a match
 
 		for (std::vector<FileData*>::const_iterator it = children.cbegin(); it != children.cend(); ++it ) {
@@ -308,10 +329,25 @@ bool FileFilterIndex::showFile(FileData* game)
 		return false;
 	}
 
+	// games that are in this index are a single bit lookup
+	auto slotIt = mGameSlots.find(game);
+	if (slotIt != mGameSlots.cend())
+	{
+		const GameBits& shown = getShownGames();
+		const int slot = slotIt->second;
+		return (shown[slot / 64] >> (slot % 64)) & 1;
+	}
+
+	// others (i.e. games shown through a collection bundle) still have to be matched key by key
+	return showFileFromKeys(game);
+}
+
+bool FileFilterIndex::showFileFromKeys(FileData* game)
+{
 	bool keepGoing = false;
 
 	for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it ) {
-		FilterDataDecl filterData = (*it);
+		const FilterDataDecl& filterData = (*it);
 		if(*(filterData.filteredByRef))
 		{
 			// try to find a match
@@ -342,29 +378,126 @@ bool FileFilterIndex::showFile(FileData* game)
 	return keepGoing;
 }
 
-bool FileFilterIndex::isKeyBeingFilteredBy(std::string key, FilterIndexType type)
+bool FileFilterIndex::isKeyBeingFilteredBy(const std::string& key, FilterIndexType type)
 {
-	const FilterIndexType filterTypes[7] = { FAVORITES_FILTER, GENRE_FILTER, PLAYER_FILTER, PUBDEV_FILTER, RATINGS_FILTER,HIDDEN_FILTER, KIDGAME_FILTER };
-	std::vector<std::string> filterKeysList[7] = { favoritesIndexFilteredKeys, genreIndexFilteredKeys, playersIndexFilteredKeys, pubDevIndexFilteredKeys, ratingsIndexFilteredKeys, hiddenIndexFilteredKeys, kidGameIndexFilteredKeys };
-
-	for (int i = 0; i < 7; i++)
+	for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it )
 	{
-		if (filterTypes[i] == type)
+		if ((*it).type == type)
 		{
-			for (std::vector<std::string>::const_iterator it = filterKeysList[i].cbegin(); it != filterKeysList[i].cend(); ++it )
-			{
-				if (key == (*it))
-				{
-					return true;
-				}
-			}
-			return false;
+			const std::vector<std::string>& filteredKeys = *((*it).currentFilteredKeys);
+			return std::find(filteredKeys.cbegin(), filteredKeys.cend(), key) != filteredKeys.cend();
 		}
 	}
 
 	return false;
 }
 
+void FileFilterIndex::addGameBits(FileData* game)
+{
+	// a game that is added again is re-keyed from scratch
+	removeGameBits(game);
+
+	int slot;
+	if (!mFreeSlots.empty())
+	{
+		slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+	else
+	{
+		slot = (int)mSlotKeys.size();
+		mSlotKeys.push_back(std::vector< std::pair<FilterIndexType, std::string> >());
+	}
+	mGameSlots[game] = slot;
+
+	// the same keys showFileFromKeys() would try, unknown keys can never be filtered for
+	std::vector< std::pair<FilterIndexType, std::string> >& keys = mSlotKeys[slot];
+	for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it )
+	{
+		std::string key = getIndexableKey(game, (*it).type, false);
+		if (key != UNKNOWN_LABEL)
+			keys.push_back(std::make_pair((*it).type, key));
+
+		if ((*it).hasSecondaryKey)
+		{
+			key = getIndexableKey(game, (*it).type, true);
+			if (key != UNKNOWN_LABEL)
+				keys.push_back(std::make_pair((*it).type, key));
+		}
+	}
+
+	for (auto it = keys.cbegin(); it != keys.cend(); ++it)
+	{
+		GameBits& bits = mGamesByKey[it->first][it->second];
+		if (bits.size() <= (size_t)(slot / 64))
+			bits.resize(slot / 64 + 1, 0);
+
+		bits[slot / 64] |= 1ULL << (slot % 64);
+	}
+
+	mShownGamesDirty = true;
+	invalidate();
+}
+
+void FileFilterIndex::removeGameBits(FileData* game)
+{
+	auto slotIt = mGameSlots.find(game);
+	if (slotIt == mGameSlots.cend())
+		return;
+
+	const int slot = slotIt->second;
+	std::vector< std::pair<FilterIndexType, std::string> >& keys = mSlotKeys[slot];
+	for (auto it = keys.cbegin(); it != keys.cend(); ++it)
+	{
+		auto bitsIt = mGamesByKey[it->first].find(it->second);
+		if (bitsIt != mGamesByKey[it->first].cend())
+			bitsIt->second[slot / 64] &= ~(1ULL << (slot % 64));
+	}
+
+	keys.clear();
+	mFreeSlots.push_back(slot);
+	mGameSlots.erase(slotIt);
+
+	mShownGamesDirty = true;
+	invalidate();
+}
+
+const FileFilterIndex::GameBits& FileFilterIndex::getShownGames()
+{
+	if (!mShownGamesDirty)
+		return mShownGames;
+
+	const size_t blockCount = (mSlotKeys.size() + 63) / 64;
+	mShownGames.assign(blockCount, ~0ULL);
+
+	for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it )
+	{
+		if (!*((*it).filteredByRef))
+			continue;
+
+		// a game is shown by a type if any of the selected keys matches it
+		GameBits matches(blockCount, 0);
+		const std::vector<std::string>& filteredKeys = *((*it).currentFilteredKeys);
+		for (auto keyIt = filteredKeys.cbegin(); keyIt != filteredKeys.cend(); ++keyIt)
+		{
+			auto bitsIt = mGamesByKey[(*it).type].find(*keyIt);
+			if (bitsIt == mGamesByKey[(*it).type].cend())
+				continue;
+
+			const GameBits& bits = bitsIt->second;
+			for (size_t i = 0; i < bits.size(); i++)
+				matches[i] |= bits[i];
+		}
+
+		// and it has to be shown by every type that is filtered
+		for (size_t i = 0; i < blockCount; i++)
+			mShownGames[i] &= matches[i];
+	}
+
+	mShownGamesDirty = false;
+	return mShownGames;
+}
+
 void FileFilterIndex::manageGenreEntryInIndex(FileData* game, bool remove)
 {
 
@@ -2,7 +2,9 @@
 #ifndef ES_APP_FILE_FILTER_INDEX_H
 #define ES_APP_FILE_FILTER_INDEX_H
 
+#include <atomic>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 class FileData;
@@ -43,9 +45,13 @@ public:
 	void debugPrintIndexes();
 	bool showFile(FileData* game);
 	bool isFiltered() { return (filterByGenre || filterByPlayers || filterByPubDev || filterByRatings || filterByFavorites || filterByHidden || filterByKidGame); };
-	bool isKeyBeingFilteredBy(std::string key, FilterIndexType type);
+	bool isKeyBeingFilteredBy(const std::string& key, FilterIndexType type);
 	std::vector<FilterDataDecl>& getFilterDataDecls();
 
+	// Changes whenever any filter, any index or any folder's children change, so filtered lists know when to rebuild.
+	static unsigned int getGeneration() { return sGeneration; };
+	static void invalidate() { ++sGeneration; };
+
 	void importIndex(FileFilterIndex* indexToImport);
 	void resetIndex();
 	void resetFilters();
@@ -67,6 +73,24 @@ private:
 
 	void clearIndex(std::map<std::string, int> indexMap);
 
+	// Every game in the index gets a slot, and every key keeps the slots of the games it matches as a bitset.
+	// Applying the filters is then a union of the selected keys' bitsets per type and an intersection across types.
+	typedef std::vector<unsigned long long> GameBits;
+
+	void addGameBits(FileData* game);
+	void removeGameBits(FileData* game);
+	const GameBits& getShownGames();
+	bool showFileFromKeys(FileData* game);
+
+	std::unordered_map<const FileData*, int> mGameSlots;
+	std::vector<int> mFreeSlots;
+	std::vector< std::vector< std::pair<FilterIndexType, std::string> > > mSlotKeys; // keys each slot was added under
+	std::unordered_map<std::string, GameBits> mGamesByKey[KIDGAME_FILTER + 1];
+	GameBits mShownGames;
+	bool mShownGamesDirty;
+
+	static std::atomic<unsigned int> sGeneration;
+
 	bool filterByGenre;
 	bool filterByPlayers;
 	bool filterByPubDev;
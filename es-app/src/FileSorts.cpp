@@ -5,35 +5,35 @@
 namespace FileSorts
 {
 	const FileData::SortType typesArr[] = {
-		FileData::SortType(&compareName, true, "filename, ascending"),
-		FileData::SortType(&compareName, false, "filename, descending"),
+		FileData::SortType(&compareName, &keyName, true, "filename, ascending"),
+		FileData::SortType(&compareName, &keyName, false, "filename, descending"),
 
-		FileData::SortType(&compareRating, true, "rating, ascending"),
-		FileData::SortType(&compareRating, false, "rating, descending"),
+		FileData::SortType(&compareRating, &keyRating, true, "rating, ascending"),
+		FileData::SortType(&compareRating, &keyRating, false, "rating, descending"),
 
-		FileData::SortType(&compareTimesPlayed, true, "times played, ascending"),
-		FileData::SortType(&compareTimesPlayed, false, "times played, descending"),
+		FileData::SortType(&compareTimesPlayed, &keyTimesPlayed, true, "times played, ascending"),
+		FileData::SortType(&compareTimesPlayed, &keyTimesPlayed, false, "times played, descending"),
 
-		FileData::SortType(&compareLastPlayed, true, "last played, ascending"),
-		FileData::SortType(&compareLastPlayed, false, "last played, descending"),
+		FileData::SortType(&compareLastPlayed, &keyLastPlayed, true, "last played, ascending"),
+		FileData::SortType(&compareLastPlayed, &keyLastPlayed, false, "last played, descending"),
 
-		FileData::SortType(&compareNumPlayers, true, "number players, ascending"),
-		FileData::SortType(&compareNumPlayers, false, "number players, descending"),
+		FileData::SortType(&compareNumPlayers, &keyNumPlayers, true, "number players, ascending"),
+		FileData::SortType(&compareNumPlayers, &keyNumPlayers, false, "number players, descending"),
 
-		FileData::SortType(&compareReleaseDate, true, "release date, ascending"),
-		FileData::SortType(&compareReleaseDate, false, "release date, descending"),
+		FileData::SortType(&compareReleaseDate, &keyReleaseDate, true, "release date, ascending"),
+		FileData::SortType(&compareReleaseDate, &keyReleaseDate, false, "release date, descending"),
 
-		FileData::SortType(&compareGenre, true, "genre, ascending"),
-		FileData::SortType(&compareGenre, false, "genre, descending"),
+		FileData::SortType(&compareGenre, &keyGenre, true, "genre, ascending"),
+		FileData::SortType(&compareGenre, &keyGenre, false, "genre, descending"),
 
-		FileData::SortType(&compareDeveloper, true, "developer, ascending"),
-		FileData::SortType(&compareDeveloper, false, "developer, descending"),
+		FileData::SortType(&compareDeveloper, &keyDeveloper, true, "developer, ascending"),
+		FileData::SortType(&compareDeveloper, &keyDeveloper, false, "developer, descending"),
 
-		FileData::SortType(&comparePublisher, true, "publisher, ascending"),
-		FileData::SortType(&comparePublisher, false, "publisher, descending"),
+		FileData::SortType(&comparePublisher, &keyPublisher, true, "publisher, ascending"),
+		FileData::SortType(&comparePublisher, &keyPublisher, false, "publisher, descending"),
 
-		FileData::SortType(&compareSystem, true, "system, ascending"),
-		FileData::SortType(&compareSystem, false, "system, descending")
+		FileData::SortType(&compareSystem, &keySystem, true, "system, ascending"),
+		FileData::SortType(&compareSystem, &keySystem, false, "system, descending")
 	};
 
 	const std::vector<FileData::SortType> SortTypes(typesArr, typesArr + sizeof(typesArr)/sizeof(typesArr[0]));
@@ -42,14 +42,14 @@ namespace FileSorts
 	bool compareName(const FileData* file1, const FileData* file2)
 	{
 		// we compare the actual metadata name, as collection files have the system appended which messes up the order
-		std::string name1 = Utils::String::toUpper(file1->metadata.get("name"));
-		std::string name2 = Utils::String::toUpper(file2->metadata.get("name"));
+		std::string name1 = Utils::String::toUpper(file1->metadata.get(MD_ID_NAME));
+		std::string name2 = Utils::String::toUpper(file2->metadata.get(MD_ID_NAME));
 		return name1.compare(name2) < 0;
 	}
 
 	bool compareRating(const FileData* file1, const FileData* file2)
 	{
-		return file1->metadata.getFloat("rating") < file2->metadata.getFloat("rating");
+		return file1->metadata.getFloat(MD_ID_RATING) < file2->metadata.getFloat(MD_ID_RATING);
 	}
 
 	bool compareTimesPlayed(const FileData* file1, const FileData* file2)
@@ -57,7 +57,7 @@ namespace FileSorts
 		//only games have playcount metadata
 		if(file1->metadata.getType() == GAME_METADATA && file2->metadata.getType() == GAME_METADATA)
 		{
-			return (file1)->metadata.getInt("playcount") < (file2)->metadata.getInt("playcount");
+			return (file1)->metadata.getInt(MD_ID_PLAYCOUNT) < (file2)->metadata.getInt(MD_ID_PLAYCOUNT);
 		}
 
 		return false;
@@ -65,41 +65,40 @@ namespace FileSorts
 
 	bool compareLastPlayed(const FileData* file1, const FileData* file2)
 	{
-		// since it's stored as an ISO string (YYYYMMDDTHHMMSS), we can compare as a string
-		// as it's a lot faster than the time casts and then time comparisons
-		return (file1)->metadata.get("lastplayed") < (file2)->metadata.get("lastplayed");
+		// the parsed time is cached by the metadata, never played games have a time of 0
+		return (file1)->metadata.getTime(MD_ID_LASTPLAYED) < (file2)->metadata.getTime(MD_ID_LASTPLAYED);
 	}
 
 	bool compareNumPlayers(const FileData* file1, const FileData* file2)
 	{
-		return (file1)->metadata.getInt("players") < (file2)->metadata.getInt("players");
+		return (file1)->metadata.getInt(MD_ID_PLAYERS) < (file2)->metadata.getInt(MD_ID_PLAYERS);
 	}
 
 	bool compareReleaseDate(const FileData* file1, const FileData* file2)
 	{
 		// since it's stored as an ISO string (YYYYMMDDTHHMMSS), we can compare as a string
 		// as it's a lot faster than the time casts and then time comparisons
-		return (file1)->metadata.get("releasedate") < (file2)->metadata.get("releasedate");
+		return (file1)->metadata.get(MD_ID_RELEASEDATE) < (file2)->metadata.get(MD_ID_RELEASEDATE);
 	}
 
 	bool compareGenre(const FileData* file1, const FileData* file2)
 	{
-		std::string genre1 = Utils::String::toUpper(file1->metadata.get("genre"));
-		std::string genre2 = Utils::String::toUpper(file2->metadata.get("genre"));
+		std::string genre1 = Utils::String::toUpper(file1->metadata.get(MD_ID_GENRE));
+		std::string genre2 = Utils::String::toUpper(file2->metadata.get(MD_ID_GENRE));
 		return genre1.compare(genre2) < 0;
 	}
 
 	bool compareDeveloper(const FileData* file1, const FileData* file2)
 	{
-		std::string developer1 = Utils::String::toUpper(file1->metadata.get("developer"));
-		std::string developer2 = Utils::String::toUpper(file2->metadata.get("developer"));
+		std::string developer1 = Utils::String::toUpper(file1->metadata.get(MD_ID_DEVELOPER));
+		std::string developer2 = Utils::String::toUpper(file2->metadata.get(MD_ID_DEVELOPER));
 		return developer1.compare(developer2) < 0;
 	}
 
 	bool comparePublisher(const FileData* file1, const FileData* file2)
 	{
-		std::string publisher1 = Utils::String::toUpper(file1->metadata.get("publisher"));
-		std::string publisher2 = Utils::String::toUpper(file2->metadata.get("publisher"));
+		std::string publisher1 = Utils::String::toUpper(file1->metadata.get(MD_ID_PUBLISHER));
+		std::string publisher2 = Utils::String::toUpper(file2->metadata.get(MD_ID_PUBLISHER));
 		return publisher1.compare(publisher2) < 0;
 	}
 
@@ -109,4 +108,63 @@ namespace FileSorts
 		std::string system2 = Utils::String::toUpper(file2->getSystemName());
 		return system1.compare(system2) < 0;
 	}
+
+	// the keys below order files exactly like the comparisons above
+
+	void keyName(const FileData* file, FileData::SortKey& key)
+	{
+		key.number = 0;
+		key.text = Utils::String::toUpper(file->metadata.get(MD_ID_NAME));
+	}
+
+	void keyRating(const FileData* file, FileData::SortKey& key)
+	{
+		key.number = file->metadata.getFloat(MD_ID_RATING);
+	}
+
+	void keyTimesPlayed(const FileData* file, FileData::SortKey& key)
+	{
+		//only games have playcount metadata
+		key.number = (file->metadata.getType() == GAME_METADATA) ? file->metadata.getInt(MD_ID_PLAYCOUNT) : 0;
+	}
+
+	void keyLastPlayed(const FileData* file, FileData::SortKey& key)
+	{
+		key.number = (double)file->metadata.getTime(MD_ID_LASTPLAYED);
+	}
+
+	void keyNumPlayers(const FileData* file, FileData::SortKey& key)
+	{
+		key.number = file->metadata.getInt(MD_ID_PLAYERS);
+	}
+
+	void keyReleaseDate(const FileData* file, FileData::SortKey& key)
+	{
+		key.number = 0;
+		key.text = file->metadata.get(MD_ID_RELEASEDATE);
+	}
+
+	void keyGenre(const FileData* file, FileData::SortKey& key)
+	{
+		key.number = 0;
+		key.text = Utils::String::toUpper(file->metadata.get(MD_ID_GENRE));
+	}
+
+	void keyDeveloper(const FileData* file, FileData::SortKey& key)
+	{
+		key.number = 0;
+		key.text = Utils::String::toUpper(file->metadata.get(MD_ID_DEVELOPER));
+	}
+
+	void keyPublisher(const FileData* file, FileData::SortKey& key)
+	{
+		key.number = 0;
+		key.text = Utils::String::toUpper(file->metadata.get(MD_ID_PUBLISHER));
+	}
+
+	void keySystem(const FileData* file, FileData::SortKey& key)
+	{
+		key.number = 0;
+		key.text = Utils::String::toUpper(file->getSystemName());
+	}
 };
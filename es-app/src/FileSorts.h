@@ -18,6 +18,17 @@ namespace FileSorts
 	bool comparePublisher(const FileData* file1, const FileData* file2);
 	bool compareSystem(const FileData* file1, const FileData* file2);
 
+	void keyName(const FileData* file, FileData::SortKey& key);
+	void keyRating(const FileData* file, FileData::SortKey& key);
+	void keyTimesPlayed(const FileData* file, FileData::SortKey& key);
+	void keyLastPlayed(const FileData* file, FileData::SortKey& key);
+	void keyNumPlayers(const FileData* file, FileData::SortKey& key);
+	void keyReleaseDate(const FileData* file, FileData::SortKey& key);
+	void keyGenre(const FileData* file, FileData::SortKey& key);
+	void keyDeveloper(const FileData* file, FileData::SortKey& key);
+	void keyPublisher(const FileData* file, FileData::SortKey& key);
+	void keySystem(const FileData* file, FileData::SortKey& key);
+
 	extern const std::vector<FileData::SortType> SortTypes;
 };
 
@@ -7,6 +7,8 @@
 #include "Settings.h"
 #include "SystemData.h"
 #include <pugixml/src/pugixml.hpp>
+#include <SDL_timer.h>
+#include <unordered_map>
 
 FileData* findOrCreateFile(SystemData* system, const std::string& path, FileType type)
 {
@@ -126,19 +128,83 @@ void parseGamelist(SystemData* system)
 			}
 
 			//load the metadata
-			std::string defaultName = file->metadata.get("name");
+			std::string defaultName = file->metadata.get(MD_ID_NAME);
 			file->metadata = MetaDataList::createFromXML(GAME_METADATA, fileNode, relativeTo);
 
 			//make sure name gets set if one didn't exist
-			if(file->metadata.get("name").empty())
-				file->metadata.set("name", defaultName);
+			if(file->metadata.get(MD_ID_NAME).empty())
+				file->metadata.set(MD_ID_NAME, defaultName);
 
 			file->metadata.resetChangedFlag();
 		}
 	}
 }
 
-void addFileDataNode(pugi::xml_node& parent, const FileData* file, const char* tag, SystemData* system)
+// Maps the resolved path of every <game> or <folder> node in a gamelist to its node.
+class GamelistIndex
+{
+public:
+	GamelistIndex(pugi::xml_node& root, const char* tag, const std::string& relativeTo) : mCanonicalIndexed(false)
+	{
+		for(pugi::xml_node fileNode = root.child(tag); fileNode; fileNode = fileNode.next_sibling(tag))
+		{
+			pugi::xml_node pathNode = fileNode.child("path");
+			if(!pathNode)
+			{
+				LOG(LogError) << "<" << tag << "> node contains no <path> child!";
+				continue;
+			}
+
+			// the first node wins, just like a search from the top of the document would
+			mNodes.insert(std::make_pair(Utils::FileSystem::resolveRelativePath(pathNode.text().get(), relativeTo, true), fileNode));
+		}
+	}
+
+	// Returns the node for path and removes it from the index, or an empty node if there is none.
+	pugi::xml_node take(const std::string& path)
+	{
+		auto it = mNodes.find(path);
+
+		// the same file may be referenced through a different path (a symlink for instance)
+		if(it == mNodes.cend() && Utils::FileSystem::exists(path))
+		{
+			indexCanonicalPaths();
+
+			auto canonicalIt = mCanonicalPaths.find(Utils::FileSystem::getCanonicalPath(path));
+			if(canonicalIt != mCanonicalPaths.cend())
+				it = mNodes.find(canonicalIt->second);
+		}
+
+		if(it == mNodes.cend())
+			return pugi::xml_node();
+
+		pugi::xml_node node = it->second;
+		mNodes.erase(it);
+		return node;
+	}
+
+private:
+	// only done on the first lookup that misses, as it has to hit the disk for every node
+	void indexCanonicalPaths()
+	{
+		if(mCanonicalIndexed)
+			return;
+
+		for(auto it = mNodes.cbegin(); it != mNodes.cend(); it++)
+		{
+			if(Utils::FileSystem::exists(it->first))
+				mCanonicalPaths.insert(std::make_pair(Utils::FileSystem::getCanonicalPath(it->first), it->first));
+		}
+
+		mCanonicalIndexed = true;
+	}
+
+	std::unordered_map<std::string, pugi::xml_node> mNodes;
+	std::unordered_map<std::string, std::string> mCanonicalPaths;
+	bool mCanonicalIndexed;
+};
+
+pugi::xml_node addFileDataNode(pugi::xml_node& parent, const FileData* file, const char* tag, SystemData* system)
 {
 	//create game and add to parent node
 	pugi::xml_node newNode = parent.append_child(tag);
@@ -153,27 +219,75 @@ void addFileDataNode(pugi::xml_node& parent, const FileData* file, const char* t
 		//if the only info is the default name, don't bother with this node
 		//delete it and ultimately do nothing
 		parent.remove_child(newNode);
+		return pugi::xml_node();
 	}else{
 		//there's something useful in there so we'll keep the node, add the path
 
 		// try and make the path relative if we can so things still work if we change the rom folder location in the future
 		newNode.prepend_child("path").text().set(Utils::FileSystem::createRelativePath(file->getPath(), system->getStartPath(), false).c_str());
+		return newNode;
 	}
 }
 
-void updateGamelist(SystemData* system)
+std::shared_ptr<GamelistChanges> takeGamelistChanges(SystemData* system)
+{
+	if(Settings::getInstance()->getBool("IgnoreGamelist"))
+		return nullptr;
+
+	FileData* rootFolder = system->getRootFolder();
+	if(rootFolder == nullptr)
+	{
+		LOG(LogError) << "Found no root folder for system \"" << system->getName() << "\"!";
+		return nullptr;
+	}
+
+	std::shared_ptr<GamelistChanges> changes = std::make_shared<GamelistChanges>();
+
+	//get only files, no folders
+	std::vector<FileData*> files = rootFolder->getFilesRecursive(GAME | FOLDER);
+	//iterate through all files, checking if they're already in the XML
+	for(std::vector<FileData*>::const_iterator fit = files.cbegin(); fit != files.cend(); ++fit)
+	{
+		const bool isGame = ((*fit)->getType() == GAME);
+
+		// check if current file has metadata, if no, skip it as it wont be in the gamelist anyway.
+		if ((*fit)->metadata.isDefault()) {
+			continue;
+		}
+
+		// do not touch if it wasn't changed anyway
+		if (!(*fit)->metadata.wasChanged())
+			continue;
+
+		GamelistChanges::Change change = { (*fit)->getPath(), isGame, addFileDataNode(changes->nodes, *fit, isGame ? "game" : "folder", system) };
+		changes->changes.push_back(change);
+		(*fit)->metadata.resetChangedFlag();
+	}
+
+	if(changes->changes.empty())
+		return nullptr;
+
+	changes->systemName = system->getName();
+	changes->startPath = system->getStartPath();
+	changes->readPath = system->getGamelistPath(false);
+	changes->writePath = system->getGamelistPath(true);
+	return changes;
+}
+
+void writeGamelistChanges(const GamelistChanges& changes)
 {
 	//We do this by reading the XML again, adding changes and then writing it back,
 	//because there might be information missing in our systemdata which would then miss in the new XML.
 	//We have the complete information for every game though, so we can simply remove a game
 	//we already have in the system from the XML, and then add it back from its GameData information...
 
-	if(Settings::getInstance()->getBool("IgnoreGamelist"))
-		return;
+	const unsigned int startTime = SDL_GetTicks();
 
 	pugi::xml_document doc;
 	pugi::xml_node root;
-	std::string xmlReadPath = system->getGamelistPath(false);
+	// earlier saves of this system that were still queued when these changes were taken write to writePath,
+	// so once it exists that's what has to be read back or their entries would be lost
+	const std::string& xmlReadPath = Utils::FileSystem::exists(changes.writePath) ? changes.writePath : changes.readPath;
 
 	if(Utils::FileSystem::exists(xmlReadPath))
 	{
@@ -197,71 +311,43 @@ void updateGamelist(SystemData* system)
 		root = doc.append_child("gameList");
 	}
 
+	// index the existing nodes by path once, instead of searching the whole document for every changed file
+	GamelistIndex index[2] = { GamelistIndex(root, "game", changes.startPath), GamelistIndex(root, "folder", changes.startPath) };
 
-	//now we have all the information from the XML. now iterate through all our games and add information from there
-	FileData* rootFolder = system->getRootFolder();
-	if (rootFolder != nullptr)
+	for(auto it = changes.changes.cbegin(); it != changes.changes.cend(); ++it)
 	{
-		int numUpdated = 0;
-
-		//get only files, no folders
-		std::vector<FileData*> files = rootFolder->getFilesRecursive(GAME | FOLDER);
-		//iterate through all files, checking if they're already in the XML
-		for(std::vector<FileData*>::const_iterator fit = files.cbegin(); fit != files.cend(); ++fit)
-		{
-			const char* tag = ((*fit)->getType() == GAME) ? "game" : "folder";
-
-			// check if current file has metadata, if no, skip it as it wont be in the gamelist anyway.
-			if ((*fit)->metadata.isDefault()) {
-				continue;
-			}
-
-			// do not touch if it wasn't changed anyway
-			if (!(*fit)->metadata.wasChanged())
-				continue;
+		// check if the file already exists in the XML
+		// if it does, remove it before adding
+		pugi::xml_node fileNode = index[it->isGame ? 0 : 1].take(it->path);
+		if(fileNode)
+			root.remove_child(fileNode);
+
+		// it was either removed or never existed to begin with; either way, we can add it now
+		if(it->node)
+			root.append_copy(it->node);
+	}
 
-			// check if the file already exists in the XML
-			// if it does, remove it before adding
-			for(pugi::xml_node fileNode = root.child(tag); fileNode; fileNode = fileNode.next_sibling(tag))
-			{
-				pugi::xml_node pathNode = fileNode.child("path");
-				if(!pathNode)
-				{
-					LOG(LogError) << "<" << tag << "> node contains no <path> child!";
-					continue;
-				}
-
-				std::string nodePath = Utils::FileSystem::resolveRelativePath(pathNode.text().get(), system->getStartPath(), true);
-				std::string gamePath = (*fit)->getPath();
-				if(nodePath == gamePath || (Utils::FileSystem::exists(nodePath) &&
-				                            Utils::FileSystem::exists(gamePath) &&
-				                            Utils::FileSystem::isEquivalent(nodePath, gamePath)))
-				{
-					// found it
-					root.remove_child(fileNode);
-					break;
-				}
-			}
+	//now write the file
 
-			// it was either removed or never existed to begin with; either way, we can add it now
-			addFileDataNode(root, *fit, tag, system);
-			++numUpdated;
-		}
+	//make sure the folders leading up to this path exist (or the write will fail)
+	const std::string& xmlWritePath = changes.writePath;
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));
 
-		//now write the file
+	LOG(LogInfo) << "Added/Updated " << changes.changes.size() << " entities in '" << xmlReadPath << "'";
 
-		if (numUpdated > 0) {
-			//make sure the folders leading up to this path exist (or the write will fail)
-			std::string xmlWritePath(system->getGamelistPath(true));
-			Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));
+	// write to a temporary file first so an interrupted save never leaves a truncated gamelist behind
+	std::string xmlTempPath = xmlWritePath + ".tmp";
+	if (!doc.save_file(xmlTempPath.c_str()) || !Utils::FileSystem::renameFile(xmlTempPath, xmlWritePath)) {
+		LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << changes.systemName << ")!";
+		Utils::FileSystem::removeFile(xmlTempPath);
+	}
 
-			LOG(LogInfo) << "Added/Updated " << numUpdated << " entities in '" << xmlReadPath << "'";
+	LOG(LogInfo) << "Gamelist for system \"" << changes.systemName << "\" updated in " << (SDL_GetTicks() - startTime) << "ms";
+}
 
-			if (!doc.save_file(xmlWritePath.c_str())) {
-				LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
-			}
-		}
-	}else{
-		LOG(LogError) << "Found no root folder for system \"" << system->getName() << "\"!";
-	}
+void updateGamelist(SystemData* system)
+{
+	std::shared_ptr<GamelistChanges> changes = takeGamelistChanges(system);
+	if(changes)
+		writeGamelistChanges(*changes);
 }
@@ -2,11 +2,40 @@
 #ifndef ES_APP_GAME_LIST_H
 #define ES_APP_GAME_LIST_H
 
+#include <pugixml/src/pugixml.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
 class SystemData;
 
+// The changed metadata of a SystemData, as the nodes it's written to gamelist.xml as.
+struct GamelistChanges
+{
+	struct Change
+	{
+		std::string		path;
+		bool			isGame;
+		pugi::xml_node	node; // in nodes, empty if there's nothing worth saving about the file anymore
+	};
+
+	std::string			systemName;
+	std::string			startPath;
+	std::string			readPath; // only read if nothing was written to writePath yet
+	std::string			writePath;
+	pugi::xml_document	nodes;
+	std::vector<Change>	changes;
+};
+
 // Loads gamelist.xml data into a SystemData.
 void parseGamelist(SystemData* system);
 
+// Takes the changed metadata of a SystemData, which is no longer a pending change afterwards. Returns nullptr if nothing changed.
+std::shared_ptr<GamelistChanges> takeGamelistChanges(SystemData* system);
+
+// Writes changes to gamelist.xml. The SystemData isn't touched, so this can be done on any thread.
+void writeGamelistChanges(const GamelistChanges& changes);
+
 // Writes currently loaded metadata for a SystemData to gamelist.xml.
 void updateGamelist(SystemData* system);
 
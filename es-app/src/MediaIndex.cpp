@@ -0,0 +1,118 @@
+#include "MediaIndex.h"
+
+#include "Log.h"
+#include "SystemData.h"
+#include <stdlib.h>
+
+MediaIndex* MediaIndex::sInstance = NULL;
+
+static const MetaDataId sMediaIds[MediaIndex::MEDIA_TYPE_COUNT] = { MD_ID_VIDEO, MD_ID_IMAGE };
+
+MediaIndex* MediaIndex::getInstance()
+{
+	if(sInstance == NULL)
+		sInstance = new MediaIndex();
+
+	return sInstance;
+}
+
+MediaIndex::MediaIndex() : mBuilt(false)
+{
+}
+
+const MediaIndex::Entry* MediaIndex::pickRandom(MediaType type)
+{
+	if(!mBuilt)
+		build();
+
+	const std::vector<Entry>& entries = mLists[type].entries;
+	if(entries.empty())
+		return NULL;
+
+	return &entries[rand() % entries.size()];
+}
+
+void MediaIndex::onFileChanged(FileData* file, FileChangeType change)
+{
+	if(!mBuilt || (change != FILE_ADDED && change != FILE_METADATA_CHANGED))
+		return;
+
+	// collection entries show the media of their source game, removing one only drops it from the collection
+	file = file->getSourceFileData();
+
+	remove(file);
+	add(file);
+}
+
+void MediaIndex::remove(FileData* file)
+{
+	if(!mBuilt)
+		return;
+
+	for(int type = 0; type < MEDIA_TYPE_COUNT; type++)
+	{
+		MediaList& list = mLists[type];
+
+		auto it = list.lookup.find(file);
+		if(it == list.lookup.cend())
+			continue;
+
+		// move the last entry into the hole instead of shifting everything after it
+		const size_t index = it->second;
+		list.lookup.erase(it);
+		if(index != list.entries.size() - 1)
+		{
+			list.entries[index] = std::move(list.entries.back());
+			list.lookup[list.entries[index].file] = index;
+		}
+		list.entries.pop_back();
+	}
+}
+
+void MediaIndex::clear()
+{
+	for(int type = 0; type < MEDIA_TYPE_COUNT; type++)
+	{
+		mLists[type].entries.clear();
+		mLists[type].lookup.clear();
+	}
+
+	mBuilt = false;
+}
+
+void MediaIndex::build()
+{
+	clear();
+	mBuilt = true;
+
+	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
+	{
+		// We only want images and videos from game systems that are not collections
+		if((*it)->isCollection() || !(*it)->isGameSystem())
+			continue;
+
+		std::vector<FileData*> games = (*it)->getRootFolder()->getFilesRecursive(GAME);
+		for(auto gameIt = games.cbegin(); gameIt != games.cend(); gameIt++)
+			add(*gameIt);
+	}
+
+	LOG(LogInfo) << "Indexed " << mLists[MEDIA_VIDEO].entries.size() << " videos and " << mLists[MEDIA_IMAGE].entries.size() << " images for the screensaver";
+}
+
+void MediaIndex::add(FileData* file)
+{
+	SystemData* system = file->getSystem();
+	if(file->getType() != GAME || system->isCollection() || !system->isGameSystem())
+		return;
+
+	for(int type = 0; type < MEDIA_TYPE_COUNT; type++)
+	{
+		const std::string& path = file->metadata.get(sMediaIds[type]);
+		if(path.empty())
+			continue;
+
+		MediaList& list = mLists[type];
+		list.lookup[file] = list.entries.size();
+		list.entries.push_back({ file, path });
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#ifndef ES_APP_MEDIA_INDEX_H
+#define ES_APP_MEDIA_INDEX_H
+
+#include "FileData.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Every game with a scraped video or image, so the screensaver can pick one at random without reading the gamelists again.
+// It's built from the loaded systems the first time it's needed and kept current through ViewController::onFileChanged.
+class MediaIndex
+{
+public:
+	enum MediaType
+	{
+		MEDIA_VIDEO,
+		MEDIA_IMAGE,
+
+		MEDIA_TYPE_COUNT
+	};
+
+	struct Entry
+	{
+		FileData*	file;
+		std::string	path;
+	};
+
+	static MediaIndex* getInstance();
+
+	// Returns NULL if no game has media of that type
+	const Entry* pickRandom(MediaType type);
+
+	void onFileChanged(FileData* file, FileChangeType change);
+	// Called by a game that's being deleted
+	void remove(FileData* file);
+	// Forget everything, i.e. when the systems are reloaded, the next pick builds it again
+	void clear();
+
+private:
+	MediaIndex();
+
+	void build();
+	void add(FileData* file);
+
+	struct MediaList
+	{
+		std::vector<Entry>							entries;
+		std::unordered_map<const FileData*, size_t>	lookup; // index into entries
+	};
+
+	static MediaIndex*	sInstance;
+
+	MediaList			mLists[MEDIA_TYPE_COUNT];
+	bool				mBuilt;
+};
+
+#endif // ES_APP_MEDIA_INDEX_H
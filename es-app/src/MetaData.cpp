@@ -1,44 +1,46 @@
 #include "MetaData.h"
 
 #include "utils/FileSystemUtil.h"
+#include "utils/TimeUtil.h"
 #include "Log.h"
 #include <pugixml/src/pugixml.hpp>
+#include <unordered_map>
 
 MetaDataDecl gameDecls[] = {
-	// key,         type,                   default,            statistic,  name in GuiMetaDataEd,  prompt in GuiMetaDataEd
-	{"name",        MD_STRING,              "",                 false,      "name",                 "enter game name"},
-	{"desc",        MD_MULTILINE_STRING,    "",                 false,      "description",          "enter description"},
-	{"image",       MD_PATH,                "",                 false,      "image",                "enter path to image"},
-	{"video",       MD_PATH     ,           "",                 false,      "video",                "enter path to video"},
-	{"marquee",     MD_PATH,                "",                 false,      "marquee",              "enter path to marquee"},
-	{"thumbnail",   MD_PATH,                "",                 false,      "thumbnail",            "enter path to thumbnail"},
-	{"rating",      MD_RATING,              "0.000000",         false,      "rating",               "enter rating"},
-	{"releasedate", MD_DATE,                "not-a-date-time",  false,      "release date",         "enter release date"},
-	{"developer",   MD_STRING,              "unknown",          false,      "developer",            "enter game developer"},
-	{"publisher",   MD_STRING,              "unknown",          false,      "publisher",            "enter game publisher"},
-	{"genre",       MD_STRING,              "unknown",          false,      "genre",                "enter game genre"},
-	{"players",     MD_INT,                 "1",                false,      "players",              "enter number of players"},
-	{"favorite",    MD_BOOL,                "false",            false,      "favorite",             "enter favorite off/on"},
-	{"hidden",      MD_BOOL,                "false",            false,      "hidden",               "enter hidden off/on" },
-	{"kidgame",     MD_BOOL,                "false",            false,      "kidgame",              "enter kidgame off/on" },
-	{"playcount",   MD_INT,                 "0",                true,       "play count",           "enter number of times played"},
-	{"lastplayed",  MD_TIME,                "0",                true,       "last played",          "enter last played date"}
+	// id,               key,         type,                   default,            statistic,  name in GuiMetaDataEd,  prompt in GuiMetaDataEd
+	{MD_ID_NAME,         "name",        MD_STRING,              "",                 false,      "name",                 "enter game name"},
+	{MD_ID_DESC,         "desc",        MD_MULTILINE_STRING,    "",                 false,      "description",          "enter description"},
+	{MD_ID_IMAGE,        "image",       MD_PATH,                "",                 false,      "image",                "enter path to image"},
+	{MD_ID_VIDEO,        "video",       MD_PATH     ,           "",                 false,      "video",                "enter path to video"},
+	{MD_ID_MARQUEE,      "marquee",     MD_PATH,                "",                 false,      "marquee",              "enter path to marquee"},
+	{MD_ID_THUMBNAIL,    "thumbnail",   MD_PATH,                "",                 false,      "thumbnail",            "enter path to thumbnail"},
+	{MD_ID_RATING,       "rating",      MD_RATING,              "0.000000",         false,      "rating",               "enter rating"},
+	{MD_ID_RELEASEDATE,  "releasedate", MD_DATE,                "not-a-date-time",  false,      "release date",         "enter release date"},
+	{MD_ID_DEVELOPER,    "developer",   MD_STRING,              "unknown",          false,      "developer",            "enter game developer"},
+	{MD_ID_PUBLISHER,    "publisher",   MD_STRING,              "unknown",          false,      "publisher",            "enter game publisher"},
+	{MD_ID_GENRE,        "genre",       MD_STRING,              "unknown",          false,      "genre",                "enter game genre"},
+	{MD_ID_PLAYERS,      "players",     MD_INT,                 "1",                false,      "players",              "enter number of players"},
+	{MD_ID_FAVORITE,     "favorite",    MD_BOOL,                "false",            false,      "favorite",             "enter favorite off/on"},
+	{MD_ID_HIDDEN,       "hidden",      MD_BOOL,                "false",            false,      "hidden",               "enter hidden off/on" },
+	{MD_ID_KIDGAME,      "kidgame",     MD_BOOL,                "false",            false,      "kidgame",              "enter kidgame off/on" },
+	{MD_ID_PLAYCOUNT,    "playcount",   MD_INT,                 "0",                true,       "play count",           "enter number of times played"},
+	{MD_ID_LASTPLAYED,   "lastplayed",  MD_TIME,                "0",                true,       "last played",          "enter last played date"}
 };
 const std::vector<MetaDataDecl> gameMDD(gameDecls, gameDecls + sizeof(gameDecls) / sizeof(gameDecls[0]));
 
 MetaDataDecl folderDecls[] = {
-	{"name",        MD_STRING,              "",                 false,      "name",                 "enter game name"},
-	{"desc",        MD_MULTILINE_STRING,    "",                 false,      "description",          "enter description"},
-	{"image",       MD_PATH,                "",                 false,      "image",                "enter path to image"},
-	{"thumbnail",   MD_PATH,                "",                 false,      "thumbnail",            "enter path to thumbnail"},
-	{"video",       MD_PATH,                "",                 false,      "video",                "enter path to video"},
-	{"marquee",     MD_PATH,                "",                 false,      "marquee",              "enter path to marquee"},
-	{"rating",      MD_RATING,              "0.000000",         false,      "rating",               "enter rating"},
-	{"releasedate", MD_DATE,                "not-a-date-time",  false,      "release date",         "enter release date"},
-	{"developer",   MD_STRING,              "unknown",          false,      "developer",            "enter game developer"},
-	{"publisher",   MD_STRING,              "unknown",          false,      "publisher",            "enter game publisher"},
-	{"genre",       MD_STRING,              "unknown",          false,      "genre",                "enter game genre"},
-	{"players",     MD_INT,                 "1",                false,      "players",              "enter number of players"}
+	{MD_ID_NAME,         "name",        MD_STRING,              "",                 false,      "name",                 "enter game name"},
+	{MD_ID_DESC,         "desc",        MD_MULTILINE_STRING,    "",                 false,      "description",          "enter description"},
+	{MD_ID_IMAGE,        "image",       MD_PATH,                "",                 false,      "image",                "enter path to image"},
+	{MD_ID_THUMBNAIL,    "thumbnail",   MD_PATH,                "",                 false,      "thumbnail",            "enter path to thumbnail"},
+	{MD_ID_VIDEO,        "video",       MD_PATH,                "",                 false,      "video",                "enter path to video"},
+	{MD_ID_MARQUEE,      "marquee",     MD_PATH,                "",                 false,      "marquee",              "enter path to marquee"},
+	{MD_ID_RATING,       "rating",      MD_RATING,              "0.000000",         false,      "rating",               "enter rating"},
+	{MD_ID_RELEASEDATE,  "releasedate", MD_DATE,                "not-a-date-time",  false,      "release date",         "enter release date"},
+	{MD_ID_DEVELOPER,    "developer",   MD_STRING,              "unknown",          false,      "developer",            "enter game developer"},
+	{MD_ID_PUBLISHER,    "publisher",   MD_STRING,              "unknown",          false,      "publisher",            "enter game publisher"},
+	{MD_ID_GENRE,        "genre",       MD_STRING,              "unknown",          false,      "genre",                "enter game genre"},
+	{MD_ID_PLAYERS,      "players",     MD_INT,                 "1",                false,      "players",              "enter number of players"}
 };
 const std::vector<MetaDataDecl> folderMDD(folderDecls, folderDecls + sizeof(folderDecls) / sizeof(folderDecls[0]));
 
@@ -58,12 +60,49 @@ const std::vector<MetaDataDecl>& getMDDByType(MetaDataListType type)
 
 
 
+// position of every MetaDataId in a list type's declarations, -1 if that type doesn't have the field
+static std::vector<int> buildSlots(const std::vector<MetaDataDecl>& mdd)
+{
+	std::vector<int> slots(MD_ID_COUNT, -1);
+	for(unsigned int i = 0; i < mdd.size(); i++)
+		slots[mdd[i].id] = i;
+
+	return slots;
+}
+
+static int getSlot(MetaDataListType type, MetaDataId id)
+{
+	static const std::vector<int> gameSlots = buildSlots(gameMDD);
+	static const std::vector<int> folderSlots = buildSlots(folderMDD);
+
+	return (type == FOLDER_METADATA) ? folderSlots[id] : gameSlots[id];
+}
+
+// game metadata has every field, so its declarations cover every key
+static std::unordered_map<std::string, MetaDataId> buildIds()
+{
+	std::unordered_map<std::string, MetaDataId> ids;
+	for(auto iter = gameMDD.cbegin(); iter != gameMDD.cend(); iter++)
+		ids[iter->key] = iter->id;
+
+	return ids;
+}
+
+static MetaDataId getIdFromKey(const std::string& key)
+{
+	static const std::unordered_map<std::string, MetaDataId> ids = buildIds();
+
+	auto it = ids.find(key);
+	return (it != ids.cend()) ? it->second : MD_ID_COUNT;
+}
+
 MetaDataList::MetaDataList(MetaDataListType type)
 	: mType(type), mWasChanged(false)
 {
 	const std::vector<MetaDataDecl>& mdd = getMDD();
+	mValues.resize(mdd.size());
 	for(auto iter = mdd.cbegin(); iter != mdd.cend(); iter++)
-		set(iter->key, iter->defaultValue);
+		set(iter->id, iter->defaultValue);
 }
 
 
@@ -84,9 +123,9 @@ MetaDataList MetaDataList::createFromXML(MetaDataListType type, pugi::xml_node&
 			{
 				value = Utils::FileSystem::resolveRelativePath(value, relativeTo, true);
 			}
-			mdl.set(iter->key, value);
+			mdl.set(iter->id, value);
 		}else{
-			mdl.set(iter->key, iter->defaultValue);
+			mdl.set(iter->id, iter->defaultValue);
 		}
 	}
 
@@ -97,53 +136,107 @@ void MetaDataList::appendToXML(pugi::xml_node& parent, bool ignoreDefaults, cons
 {
 	const std::vector<MetaDataDecl>& mdd = getMDD();
 
-	for(auto mddIter = mdd.cbegin(); mddIter != mdd.cend(); mddIter++)
+	for(unsigned int i = 0; i < mdd.size(); i++)
 	{
-		auto mapIter = mMap.find(mddIter->key);
-		if(mapIter != mMap.cend())
-		{
-			// we have this value!
-			// if it's just the default (and we ignore defaults), don't write it
-			if(ignoreDefaults && mapIter->second == mddIter->defaultValue)
-				continue;
-			
-			// try and make paths relative if we can
-			std::string value = mapIter->second;
-			if (mddIter->type == MD_PATH)
-				value = Utils::FileSystem::createRelativePath(value, relativeTo, true);
-
-			parent.append_child(mapIter->first.c_str()).text().set(value.c_str());
-		}
+		const MetaDataDecl& decl = mdd[i];
+		const std::string& value = mValues[i].string;
+
+		// if it's just the default (and we ignore defaults), don't write it
+		if(ignoreDefaults && value == decl.defaultValue)
+			continue;
+
+		// try and make paths relative if we can
+		if (decl.type == MD_PATH)
+			parent.append_child(decl.key.c_str()).text().set(Utils::FileSystem::createRelativePath(value, relativeTo, true).c_str());
+		else
+			parent.append_child(decl.key.c_str()).text().set(value.c_str());
 	}
 }
 
-void MetaDataList::set(const std::string& key, const std::string& value)
+const MetaDataList::Value* MetaDataList::getValue(MetaDataId id) const
 {
-	mMap[key] = value;
+	const int slot = (id < MD_ID_COUNT) ? getSlot(mType, id) : -1;
+	return (slot >= 0) ? &mValues[slot] : NULL;
+}
+
+void MetaDataList::set(MetaDataId id, const std::string& value)
+{
+	const int slot = (id < MD_ID_COUNT) ? getSlot(mType, id) : -1;
+	if(slot < 0)
+	{
+		LOG(LogError) << "Tried to set metadata " << id << " which doesn't exist for this type!";
+		return;
+	}
+
+	const MetaDataDecl& decl = getMDD()[slot];
+	Value& entry = mValues[slot];
+	entry.string = value;
+
+	switch(decl.type)
+	{
+		case MD_INT:    { entry.number = atoi(value.c_str()); } break;
+		case MD_FLOAT:
+		case MD_RATING: { entry.number = atof(value.c_str()); } break;
+		case MD_DATE:
+		case MD_TIME:   { entry.number = (value == decl.defaultValue) ? 0 : (double)Utils::Time::stringToTime(value); } break;
+		default:        { entry.number = 0; } break;
+	}
+
 	mWasChanged = true;
 }
 
+void MetaDataList::set(const std::string& key, const std::string& value)
+{
+	set(getIdFromKey(key), value);
+}
+
+const std::string& MetaDataList::get(MetaDataId id) const
+{
+	static const std::string empty;
+
+	const Value* entry = getValue(id);
+	return entry ? entry->string : empty;
+}
+
 const std::string& MetaDataList::get(const std::string& key) const
 {
-	return mMap.at(key);
+	return get(getIdFromKey(key));
+}
+
+int MetaDataList::getInt(MetaDataId id) const
+{
+	const Value* entry = getValue(id);
+	return entry ? (int)entry->number : 0;
 }
 
 int MetaDataList::getInt(const std::string& key) const
 {
-	return atoi(get(key).c_str());
+	return getInt(getIdFromKey(key));
+}
+
+float MetaDataList::getFloat(MetaDataId id) const
+{
+	const Value* entry = getValue(id);
+	return entry ? (float)entry->number : 0.0f;
 }
 
 float MetaDataList::getFloat(const std::string& key) const
 {
-	return (float)atof(get(key).c_str());
+	return getFloat(getIdFromKey(key));
+}
+
+time_t MetaDataList::getTime(MetaDataId id) const
+{
+	const Value* entry = getValue(id);
+	return entry ? (time_t)entry->number : 0;
 }
 
 bool MetaDataList::isDefault()
 {
 	const std::vector<MetaDataDecl>& mdd = getMDD();
 
-	for (unsigned int i = 1; i < mMap.size(); i++) {
-		if (mMap.at(mdd[i].key) != mdd[i].defaultValue) return false;
+	for (unsigned int i = 1; i < mValues.size(); i++) {
+		if (mValues[i].string != mdd[i].defaultValue) return false;
 	}
 
 	return true;
@@ -2,7 +2,8 @@
 #ifndef ES_APP_META_DATA_H
 #define ES_APP_META_DATA_H
 
-#include <map>
+#include <string>
+#include <time.h>
 #include <vector>
 
 namespace pugi { class xml_node; }
@@ -23,8 +24,33 @@ enum MetaDataType
 	MD_TIME //used for lastplayed
 };
 
+// Identifies a metadata field independently of the list type, prefer these over the string keys in hot paths.
+enum MetaDataId
+{
+	MD_ID_NAME,
+	MD_ID_DESC,
+	MD_ID_IMAGE,
+	MD_ID_VIDEO,
+	MD_ID_MARQUEE,
+	MD_ID_THUMBNAIL,
+	MD_ID_RATING,
+	MD_ID_RELEASEDATE,
+	MD_ID_DEVELOPER,
+	MD_ID_PUBLISHER,
+	MD_ID_GENRE,
+	MD_ID_PLAYERS,
+	MD_ID_FAVORITE,
+	MD_ID_HIDDEN,
+	MD_ID_KIDGAME,
+	MD_ID_PLAYCOUNT,
+	MD_ID_LASTPLAYED,
+
+	MD_ID_COUNT
+};
+
 struct MetaDataDecl
 {
+	MetaDataId id;
 	std::string key;
 	MetaDataType type;
 	std::string defaultValue;
@@ -49,11 +75,18 @@ public:
 
 	MetaDataList(MetaDataListType type);
 	
+	void set(MetaDataId id, const std::string& value);
 	void set(const std::string& key, const std::string& value);
 
+	const std::string& get(MetaDataId id) const;
 	const std::string& get(const std::string& key) const;
+
+	// these return the value cached by set() instead of parsing the string every time
+	int getInt(MetaDataId id) const;
 	int getInt(const std::string& key) const;
+	float getFloat(MetaDataId id) const;
 	float getFloat(const std::string& key) const;
+	time_t getTime(MetaDataId id) const; // MD_DATE and MD_TIME, 0 if not set
 
 	bool isDefault();
 
@@ -64,8 +97,17 @@ public:
 	inline const std::vector<MetaDataDecl>& getMDD() const { return getMDDByType(getType()); }
 
 private:
+	struct Value
+	{
+		std::string string;
+		double number; // parsed string for MD_INT, MD_FLOAT, MD_RATING, MD_DATE and MD_TIME
+	};
+
+	// returns NULL if the field doesn't exist for this list type
+	const Value* getValue(MetaDataId id) const;
+
 	MetaDataListType mType;
-	std::map<std::string, std::string> mMap;
+	std::vector<Value> mValues; // indexed by the position of the field in getMDD()
 	bool mWasChanged;
 };
 
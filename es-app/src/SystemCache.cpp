@@ -0,0 +1,296 @@
+#include "SystemCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "FileData.h"
+#include "FileSorts.h"
+#include "Log.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+
+namespace SystemCache
+{
+	// bump this whenever the layout written by save() changes
+	static const long long CACHE_VERSION = 2;
+	static const char      CACHE_MAGIC[] = "ESLIBCACHE";
+
+	// every value is written as a native 64 bit integer, strings are prefixed by their length
+	class Writer
+	{
+	public:
+		void writeInt(long long value) { mBuffer.append((const char*)&value, sizeof(value)); }
+		void writeString(const std::string& str) { writeInt((long long)str.size()); mBuffer.append(str); }
+		void writeRaw(const std::string& data) { mBuffer.append(data); }
+
+		const std::string& getBuffer() const { return mBuffer; }
+
+	private:
+		std::string mBuffer;
+	};
+
+	class Reader
+	{
+	public:
+		Reader(const std::string& data) : mData(data), mOffset(0), mFailed(false) {}
+
+		long long readInt()
+		{
+			long long value = 0;
+			if(mFailed || mOffset + sizeof(value) > mData.size())
+			{
+				mFailed = true;
+				return 0;
+			}
+
+			memcpy(&value, mData.data() + mOffset, sizeof(value));
+			mOffset += sizeof(value);
+			return value;
+		}
+
+		std::string readString()
+		{
+			long long length = readInt();
+			if(mFailed || length < 0 || (size_t)length > mData.size() - mOffset)
+			{
+				mFailed = true;
+				return "";
+			}
+
+			std::string str(mData, mOffset, (size_t)length);
+			mOffset += (size_t)length;
+			return str;
+		}
+
+		// returns true and skips over data if it's next in the buffer
+		bool matchRaw(const std::string& data)
+		{
+			if(mFailed || mData.compare(mOffset, data.size(), data) != 0)
+				return false;
+
+			mOffset += data.size();
+			return true;
+		}
+
+		bool failed() const { return mFailed; }
+
+	private:
+		const std::string& mData;
+		size_t mOffset;
+		bool mFailed;
+	};
+
+	std::string getCachePath(const SystemData* system)
+	{
+		return Utils::FileSystem::getHomePath() + "/.emulationstation/cache/" + system->getName() + ".bin";
+	}
+
+	// everything besides the folder contents that the loaded tree depends on
+	static std::string buildStamp(const SystemData* system)
+	{
+		Writer stamp;
+
+		stamp.writeString(CACHE_MAGIC);
+		stamp.writeInt(CACHE_VERSION);
+
+		stamp.writeString(system->getStartPath());
+		const std::vector<std::string>& extensions = system->getExtensions();
+		stamp.writeInt((long long)extensions.size());
+		for(auto it = extensions.cbegin(); it != extensions.cend(); it++)
+			stamp.writeString(*it);
+
+		stamp.writeInt(Settings::getInstance()->getBool("ParseGamelistOnly"));
+		stamp.writeInt(Settings::getInstance()->getBool("IgnoreGamelist"));
+		stamp.writeInt(Settings::getInstance()->getBool("ShowHiddenFiles"));
+
+		const std::string gamelistPath = system->getGamelistPath(false);
+		stamp.writeString(gamelistPath);
+		stamp.writeInt((long long)Utils::FileSystem::getModificationTime(gamelistPath));
+		stamp.writeInt((long long)Utils::FileSystem::getFileSize(gamelistPath));
+
+		return stamp.getBuffer();
+	}
+
+	static void writeChildren(Writer& writer, const FileData* folder)
+	{
+		// a cache hit isn't sorted again, so it's written in the default order rather than whatever the session left
+		const FileData::SortType& sortType = FileSorts::SortTypes.at(0);
+		std::vector<FileData*> children = folder->getChildren();
+		std::stable_sort(children.begin(), children.end(), *sortType.comparisonFunction);
+		if(!sortType.ascending)
+			std::reverse(children.begin(), children.end());
+
+		writer.writeInt((long long)children.size());
+
+		for(auto it = children.cbegin(); it != children.cend(); it++)
+		{
+			const FileData* file = *it;
+			const MetaDataList& metadata = file->metadata;
+			const std::vector<MetaDataDecl>& mdd = metadata.getMDD();
+
+			writer.writeInt(file->getType());
+			writer.writeString(file->getPath());
+
+			writer.writeInt(metadata.getType());
+			writer.writeInt(metadata.wasChanged());
+			writer.writeInt((long long)mdd.size());
+			for(auto mddIt = mdd.cbegin(); mddIt != mdd.cend(); mddIt++)
+				writer.writeString(metadata.get(mddIt->id));
+
+			writeChildren(writer, file);
+		}
+	}
+
+	static void deleteChildren(FileData* folder)
+	{
+		while(!folder->getChildren().empty())
+		{
+			FileData* child = folder->getChildren().back();
+			deleteChildren(child);
+			delete child;
+		}
+	}
+
+	static bool readChildren(Reader& reader, FileData* folder, SystemData* system, int& fileCount)
+	{
+		long long childCount = reader.readInt();
+		for(long long i = 0; i < childCount && !reader.failed(); i++)
+		{
+			FileType type = (FileType)reader.readInt();
+			std::string path = reader.readString();
+
+			MetaDataListType mdType = (MetaDataListType)reader.readInt();
+			bool wasChanged = reader.readInt() != 0;
+			long long valueCount = reader.readInt();
+
+			if(reader.failed() || (type != GAME && type != FOLDER) || (mdType != GAME_METADATA && mdType != FOLDER_METADATA))
+				return false;
+
+			MetaDataList metadata(mdType);
+			const std::vector<MetaDataDecl>& mdd = metadata.getMDD();
+			if(valueCount != (long long)mdd.size())
+				return false;
+
+			for(auto mddIt = mdd.cbegin(); mddIt != mdd.cend(); mddIt++)
+				metadata.set(mddIt->id, reader.readString());
+
+			if(!wasChanged)
+				metadata.resetChangedFlag();
+
+			FileData* file = new FileData(type, path, system->getSystemEnvData(), system);
+			file->metadata = metadata;
+			folder->addChild(file);
+			fileCount++;
+
+			if(!readChildren(reader, file, system, fileCount))
+				return false;
+		}
+
+		return !reader.failed();
+	}
+
+	bool load(SystemData* system)
+	{
+		const std::string path = getCachePath(system);
+
+		if(Settings::getInstance()->getBool("RebuildLibraryCache"))
+		{
+			LOG(LogInfo) << "Library cache miss for system \"" << system->getName() << "\" (rebuild requested)";
+			return false;
+		}
+
+		// read the whole file in one go, everything else is parsed from memory
+		std::string data;
+		std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+		if(file.good())
+		{
+			file.seekg(0, std::ios::end);
+			data.resize((size_t)file.tellg());
+			file.seekg(0, std::ios::beg);
+			file.read(&data[0], data.size());
+		}
+
+		if(!file.good() || data.empty())
+		{
+			LOG(LogInfo) << "Library cache miss for system \"" << system->getName() << "\" (no cache)";
+			return false;
+		}
+
+		Reader reader(data);
+
+		if(!reader.matchRaw(buildStamp(system)))
+		{
+			LOG(LogInfo) << "Library cache miss for system \"" << system->getName() << "\" (gamelist or configuration changed)";
+			return false;
+		}
+
+		// any file added, removed or renamed shows up in the modification time of its folder
+		std::vector< std::pair<std::string, time_t> > folders;
+		long long folderCount = reader.readInt();
+		for(long long i = 0; i < folderCount && !reader.failed(); i++)
+		{
+			std::string folderPath = reader.readString();
+			time_t folderTime = (time_t)reader.readInt();
+
+			if(!reader.failed() && Utils::FileSystem::getModificationTime(folderPath) != folderTime)
+			{
+				LOG(LogInfo) << "Library cache miss for system \"" << system->getName() << "\" (\"" << folderPath << "\" changed)";
+				return false;
+			}
+
+			folders.push_back(std::make_pair(folderPath, folderTime));
+		}
+
+		// detected while building the cache, so the gamelist view doesn't have to look for local media
+		const unsigned int mediaFlags = (unsigned int)reader.readInt();
+
+		int fileCount = 0;
+		if(reader.failed() || !readChildren(reader, system->getRootFolder(), system, fileCount))
+		{
+			LOG(LogWarning) << "Library cache miss for system \"" << system->getName() << "\" (\"" << path << "\" is corrupt)";
+			deleteChildren(system->getRootFolder());
+			return false;
+		}
+
+		system->getScannedFolders() = folders;
+		system->setMediaFlags(mediaFlags);
+
+		LOG(LogInfo) << "Library cache hit for system \"" << system->getName() << "\" (" << fileCount << " entries)";
+		return true;
+	}
+
+	void save(SystemData* system)
+	{
+		Writer writer;
+
+		writer.writeRaw(buildStamp(system));
+
+		const std::vector< std::pair<std::string, time_t> >& folders = system->getScannedFolders();
+		writer.writeInt((long long)folders.size());
+		for(auto it = folders.cbegin(); it != folders.cend(); it++)
+		{
+			writer.writeString(it->first);
+			writer.writeInt((long long)it->second);
+		}
+
+		writer.writeInt(system->getMediaFlags());
+
+		writeChildren(writer, system->getRootFolder());
+
+		// write to a temporary file first so an interrupted save never leaves a truncated cache behind
+		const std::string path = getCachePath(system);
+		const std::string tempPath = path + ".tmp";
+		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(path));
+
+		std::ofstream file(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(writer.getBuffer().data(), writer.getBuffer().size());
+		file.close();
+
+		if(file.fail() || !Utils::FileSystem::renameFile(tempPath, path))
+		{
+			LOG(LogError) << "Error writing library cache \"" << path << "\" (for system " << system->getName() << ")!";
+			Utils::FileSystem::removeFile(tempPath);
+		}
+	}
+}
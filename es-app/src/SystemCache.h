@@ -0,0 +1,24 @@
+#pragma once
+#ifndef ES_APP_SYSTEM_CACHE_H
+#define ES_APP_SYSTEM_CACHE_H
+
+#include <string>
+
+class SystemData;
+
+// A binary snapshot of a system's FileData tree and metadata, stored in ~/.emulationstation/cache/<system>.bin.
+// It is validated against the modification times of every scanned folder and the gamelist.xml modification
+// time and size, so an unchanged system can be loaded without scanning its folders or parsing its gamelist.
+namespace SystemCache
+{
+	// Rebuilds the tree under the system's root folder from its cache. Returns false if the cache is missing,
+	// out of date or unreadable, in which case the root folder is left empty.
+	bool load(SystemData* system);
+
+	// Writes the system's current tree to its cache.
+	void save(SystemData* system);
+
+	std::string getCachePath(const SystemData* system);
+}
+
+#endif // ES_APP_SYSTEM_CACHE_H
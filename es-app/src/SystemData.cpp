@@ -1,16 +1,22 @@
 #include "SystemData.h"
 
 #include "utils/FileSystemUtil.h"
+#include "utils/ThreadPool.h"
 #include "CollectionSystemManager.h"
 #include "FileFilterIndex.h"
 #include "FileSorts.h"
 #include "Gamelist.h"
 #include "Log.h"
+#include "MediaIndex.h"
 #include "platform.h"
 #include "Settings.h"
+#include "SystemCache.h"
 #include "ThemeData.h"
 #include "views/UIModeController.h"
+#include "Window.h"
 #include <pugixml/src/pugixml.hpp>
+#include <SDL_timer.h>
+#include <atomic>
 #include <fstream>
 #ifdef WIN32
 #include <Windows.h>
@@ -18,8 +24,16 @@
 
 std::vector<SystemData*> SystemData::sSystemVector;
 
+// one thread, so the writes of a gamelist happen in the order its changes were taken
+static Utils::ThreadPool& getGamelistSavePool()
+{
+	static Utils::ThreadPool pool(1);
+	return pool;
+}
+
 SystemData::SystemData(const std::string& name, const std::string& fullName, SystemEnvironmentData* envData, const std::string& themeFolder, bool CollectionSystem) :
-	mName(name), mFullName(fullName), mEnvData(envData), mThemeFolder(themeFolder), mIsCollectionSystem(CollectionSystem), mIsGameSystem(true)
+	mName(name), mFullName(fullName), mEnvData(envData), mThemeFolder(themeFolder), mIsCollectionSystem(CollectionSystem), mIsGameSystem(true), mLoadedFromCache(false),
+	mCacheOutdated(false), mMediaFlags(0), mMediaDetected(false)
 {
 	mFilterIndex = new FileFilterIndex();
 
@@ -27,15 +41,27 @@ SystemData::SystemData(const std::string& name, const std::string& fullName, Sys
 	if(!CollectionSystem)
 	{
 		mRootFolder = new FileData(FOLDER, mEnvData->mStartPath, mEnvData, this);
-		mRootFolder->metadata.set("name", mFullName);
+		mRootFolder->metadata.set(MD_ID_NAME, mFullName);
 
-		if(!Settings::getInstance()->getBool("ParseGamelistOnly"))
-			populateFolder(mRootFolder);
+		const bool useCache = Settings::getInstance()->getBool("LibraryCache");
+		mLoadedFromCache = useCache && SystemCache::load(this);
+
+		if(!mLoadedFromCache)
+		{
+			if(!Settings::getInstance()->getBool("ParseGamelistOnly"))
+				populateFolder(mRootFolder);
 
-		if(!Settings::getInstance()->getBool("IgnoreGamelist"))
-			parseGamelist(this);
+			if(!Settings::getInstance()->getBool("IgnoreGamelist"))
+				parseGamelist(this);
 
-		mRootFolder->sort(FileSorts::SortTypes.at(0));
+			mRootFolder->sort(FileSorts::SortTypes.at(0));
+
+			// still on the loading thread, rather than when the gamelist view is created
+			detectMedia();
+
+			if(useCache)
+				SystemCache::save(this);
+		}
 
 		indexAllGameFilters(mRootFolder);
 	}
@@ -45,19 +71,79 @@ SystemData::SystemData(const std::string& name, const std::string& fullName, Sys
 		mRootFolder = new FileData(FOLDER, "" + name, mEnvData, this);
 	}
 	setIsGameSystemStatus();
-	loadTheme();
+
+	// the theme is loaded separately through loadTheme(), as game systems may be built on a worker thread
 }
 
 SystemData::~SystemData()
+{
+	delete mRootFolder;
+	delete mFilterIndex;
+}
+
+void SystemData::saveGamelist()
 {
 	//save changed game data back to xml
 	if(!Settings::getInstance()->getBool("IgnoreGamelist") && Settings::getInstance()->getBool("SaveGamelistsOnExit") && !mIsCollectionSystem)
 	{
+		const std::string oldPath = getGamelistPath(false);
+		const time_t      oldTime = Utils::FileSystem::getModificationTime(oldPath);
+		const size_t      oldSize = Utils::FileSystem::getFileSize(oldPath);
+
+		// whatever is written is no longer a pending change, just like after parsing the new gamelist
 		updateGamelist(this);
+
+		// the cache is validated against the gamelist, so it has to follow it whenever the gamelist was rewritten
+		const std::string newPath = getGamelistPath(false);
+		if(Settings::getInstance()->getBool("LibraryCache") && (mCacheOutdated || newPath != oldPath || Utils::FileSystem::getModificationTime(newPath) != oldTime || Utils::FileSystem::getFileSize(newPath) != oldSize))
+		{
+			mCacheOutdated = false;
+
+			// scraping may have added the first image or video
+			detectMedia();
+
+			SystemCache::save(this);
+		}
 	}
+}
 
-	delete mRootFolder;
-	delete mFilterIndex;
+void SystemData::saveGamelistInBackground()
+{
+	if(mIsCollectionSystem)
+		return;
+
+	std::shared_ptr<GamelistChanges> changes = takeGamelistChanges(this);
+	if(!changes)
+		return;
+
+	// the game data is only read here, the worker just gets the nodes to write
+	mCacheOutdated = true;
+	getGamelistSavePool().queueWorkItem([changes] { writeGamelistChanges(*changes); });
+}
+
+unsigned int SystemData::getMediaFlags()
+{
+	if(!mMediaDetected)
+		detectMedia();
+
+	return mMediaFlags;
+}
+
+void SystemData::detectMedia()
+{
+	const unsigned int allMedia = MEDIA_THUMBNAIL | MEDIA_VIDEO;
+
+	mMediaFlags = 0;
+	std::vector<FileData*> files = mRootFolder->getFilesRecursive(GAME | FOLDER);
+	for(auto it = files.cbegin(); it != files.cend() && mMediaFlags != allMedia; it++)
+	{
+		if(!(mMediaFlags & MEDIA_VIDEO) && !(*it)->getVideoPath().empty())
+			mMediaFlags |= MEDIA_VIDEO;
+		if(!(mMediaFlags & MEDIA_THUMBNAIL) && !(*it)->getThumbnailPath().empty())
+			mMediaFlags |= MEDIA_THUMBNAIL;
+	}
+
+	mMediaDetected = true;
 }
 
 void SystemData::setIsGameSystemStatus()
@@ -71,6 +157,8 @@ void SystemData::setIsGameSystemStatus()
 void SystemData::populateFolder(FileData* folder)
 {
 	const std::string& folderPath = folder->getPath();
+	mScannedFolders.push_back(std::make_pair(folderPath, Utils::FileSystem::getModificationTime(folderPath)));
+
 	if(!Utils::FileSystem::isDirectory(folderPath))
 	{
 		LOG(LogWarning) << "Error - folder with path \"" << folderPath << "\" is not a directory!";
@@ -165,7 +253,7 @@ std::vector<std::string> readList(const std::string& str, const char* delims = "
 }
 
 //creates systems from information located in a config file
-bool SystemData::loadConfig()
+bool SystemData::loadConfig(Window* window)
 {
 	deleteSystems();
 
@@ -199,6 +287,8 @@ bool SystemData::loadConfig()
 		return false;
 	}
 
+	std::vector< std::function<SystemData*()> > loaders;
+
 	for(pugi::xml_node system = systemList.child("system"); system; system = system.next_sibling("system"))
 	{
 		std::string name, fullname, path, cmd, themeFolder;
@@ -263,15 +353,69 @@ bool SystemData::loadConfig()
 		envData->mLaunchCommand = cmd;
 		envData->mPlatformIds = platformIds;
 
-		SystemData* newSys = new SystemData(name, fullname, envData, themeFolder);
+		// the system itself is built afterwards, possibly in parallel with the others
+		loaders.push_back([name, fullname, envData, themeFolder] { return new SystemData(name, fullname, envData, themeFolder); });
+	}
+
+	// scan the rom folders and parse the gamelists, one task per system
+	const int systemCount = (int)loaders.size();
+	std::vector<SystemData*> loadedSystems(systemCount, NULL);
+	std::atomic<int> loadedCount(0);
+
+	auto renderProgress = [window, systemCount, &loadedCount]
+	{
+		if(window != NULL)
+			window->renderLoadingScreen("LOADING SYSTEMS... " + std::to_string(loadedCount.load()) + " / " + std::to_string(systemCount));
+	};
+
+	if(Settings::getInstance()->getBool("ParallelSystemLoading") && systemCount > 1)
+	{
+		Utils::ThreadPool pool(std::min(systemCount, Utils::ThreadPool::getHardwareThreadCount()));
+		LOG(LogInfo) << "Loading " << systemCount << " systems on " << pool.getThreadCount() << " threads...";
+
+		for(int i = 0; i < systemCount; i++)
+		{
+			pool.queueWorkItem([i, &loaders, &loadedSystems, &loadedCount]
+			{
+				loadedSystems[i] = loaders[i]();
+				++loadedCount;
+			});
+		}
+
+		// OpenGL calls have to stay on this thread, so the splash is redrawn from here while waiting
+		pool.wait(renderProgress, 100);
+	}
+	else
+	{
+		for(int i = 0; i < systemCount; i++)
+		{
+			loadedSystems[i] = loaders[i]();
+			++loadedCount;
+			renderProgress();
+		}
+	}
+
+	// merge the results in config order, so the system order does not depend on which thread finished first
+	int cacheHits = 0;
+	for(auto it = loadedSystems.cbegin(); it != loadedSystems.cend(); it++)
+	{
+		SystemData* newSys = *it;
+		if(newSys->isLoadedFromCache())
+			++cacheHits;
+
 		if(newSys->getRootFolder()->getChildrenByFilename().size() == 0)
 		{
-			LOG(LogWarning) << "System \"" << name << "\" has no games! Ignoring it.";
+			LOG(LogWarning) << "System \"" << newSys->getName() << "\" has no games! Ignoring it.";
 			delete newSys;
 		}else{
+			newSys->loadTheme();
 			sSystemVector.push_back(newSys);
 		}
 	}
+
+	if(Settings::getInstance()->getBool("LibraryCache"))
+		LOG(LogInfo) << "Library cache: " << cacheHits << " hits, " << (systemCount - cacheHits) << " misses";
+
 	CollectionSystemManager::get()->loadCollectionSystems();
 
 	return true;
@@ -325,6 +469,28 @@ void SystemData::writeExampleConfig(const std::string& path)
 
 void SystemData::deleteSystems()
 {
+	// usually done already, the changes made during the session were written in the background
+	getGamelistSavePool().wait();
+
+	// every system only touches its own gamelist and cache, so they are all written at the same time
+	if(!sSystemVector.empty())
+	{
+		Utils::ThreadPool pool(std::min((int)sSystemVector.size(), Utils::ThreadPool::getHardwareThreadCount()));
+		const unsigned int startTime = SDL_GetTicks();
+
+		for(auto it = sSystemVector.cbegin(); it != sSystemVector.cend(); it++)
+		{
+			SystemData* system = *it;
+			pool.queueWorkItem([system] { system->saveGamelist(); });
+		}
+
+		pool.wait();
+		LOG(LogInfo) << "Saved gamelists for " << sSystemVector.size() << " systems in " << (SDL_GetTicks() - startTime) << "ms";
+	}
+
+	// the games are all about to go, no point in removing them from the screensaver's index one by one
+	MediaIndex::getInstance()->clear();
+
 	for(unsigned int i = 0; i < sSystemVector.size(); i++)
 	{
 		delete sSystemVector.at(i);
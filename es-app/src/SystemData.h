@@ -6,11 +6,20 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <time.h>
 #include <vector>
 
 class FileData;
 class FileFilterIndex;
 class ThemeData;
+class Window;
+
+// What kind of media a system's games have, see SystemData::getMediaFlags()
+enum MediaFlags
+{
+	MEDIA_THUMBNAIL = 1,
+	MEDIA_VIDEO     = 2
+};
 
 struct SystemEnvironmentData
 {
@@ -45,8 +54,8 @@ public:
 	unsigned int getGameCount() const;
 	unsigned int getDisplayedGameCount() const;
 
-	static void deleteSystems();
-	static bool loadConfig(); //Load the system config file at getConfigPath(). Returns true if no errors were encountered. An example will be written if the file doesn't exist.
+	static void deleteSystems(); // waits for the background saves and writes back what is left of every gamelist on worker threads before deleting them
+	static bool loadConfig(Window* window = NULL); //Load the system config file at getConfigPath(). Returns true if no errors were encountered. An example will be written if the file doesn't exist. Progress is drawn on window's loading screen if it is set.
 	static void writeExampleConfig(const std::string& path);
 	static std::string getConfigPath(bool forWrite); // if forWrite, will only return ~/.emulationstation/es_systems.cfg, never /etc/emulationstation/es_systems.cfg
 
@@ -67,8 +76,24 @@ public:
 	// Load or re-load theme.
 	void loadTheme();
 
+	// Write changed metadata back to gamelist.xml and refresh the library cache if needed.
+	void saveGamelist();
+	// Takes the changed metadata now and writes it to gamelist.xml on a background thread, so it doesn't pile up for the exit.
+	void saveGamelistInBackground();
+
 	FileFilterIndex* getIndex() { return mFilterIndex; };
 
+	// Every folder visited while scanning for games along with its modification time, used to validate the library cache.
+	inline std::vector< std::pair<std::string, time_t> >& getScannedFolders() { return mScannedFolders; };
+	inline bool isLoadedFromCache() const { return mLoadedFromCache; };
+
+	// MediaFlags of the games, used to pick the gamelist view in automatic mode. Looking for local media stats
+	// files for every game, so game systems detect it while loading (or read it from the library cache) and
+	// collections detect it the first time it's asked for.
+	unsigned int getMediaFlags();
+	inline void setMediaFlags(unsigned int flags) { mMediaFlags = flags; mMediaDetected = true; };
+	void detectMedia();
+
 private:
 	bool mIsCollectionSystem;
 	bool mIsGameSystem;
@@ -85,6 +110,13 @@ private:
 	FileFilterIndex* mFilterIndex;
 
 	FileData* mRootFolder;
+
+	std::vector< std::pair<std::string, time_t> > mScannedFolders;
+	bool mLoadedFromCache;
+	bool mCacheOutdated; // the gamelist was written in the background, the cache follows it in saveGamelist()
+
+	unsigned int mMediaFlags;
+	bool mMediaDetected;
 };
 
 #endif // ES_APP_SYSTEM_DATA_H
@@ -14,8 +14,6 @@
 #include "Renderer.h"
 #include "Sound.h"
 #include "SystemData.h"
-#include <pugixml/src/pugixml.hpp>
-#include <unordered_map>
 #include <time.h>
 
 #define FADE_TIME 			300
@@ -24,16 +22,13 @@ SystemScreenSaver::SystemScreenSaver(Window* window) :
 	mVideoScreensaver(NULL),
 	mImageScreensaver(NULL),
 	mWindow(window),
-	mVideosCounted(false),
-	mVideoCount(0),
-	mImagesCounted(false),
-	mImageCount(0),
 	mState(STATE_INACTIVE),
 	mOpacity(0.0f),
 	mTimer(0),
 	mSystemName(""),
 	mGameName(""),
 	mCurrentGame(NULL),
+	mNextGame(NULL),
 	mStopBackgroundAudio(true)
 {
 	mWindow->setScreenSaver(this);
@@ -76,18 +71,11 @@ void SystemScreenSaver::startScreenSaver()
 		mVideoChangeTime = Settings::getInstance()->getInt("ScreenSaverSwapVideoTimeout");
 		mOpacity = 0.0f;
 
-		// Load a random video
+		// Load a random video, the one picked while the previous one was showing if there is one
 		std::string path = "";
-		pickRandomVideo(path);
+		takeNextItem(path);
 
-		int retry = 200;
-		while(retry > 0 && ((path.empty() || !Utils::FileSystem::exists(path)) || mCurrentGame == NULL))
-		{
-			retry--;
-			pickRandomVideo(path);
-		}
-
-		if (!path.empty() && Utils::FileSystem::exists(path))
+		if (!path.empty())
 		{
 #ifdef _RPI_
 			// Create the correct type of video component
@@ -116,6 +104,7 @@ void SystemScreenSaver::startScreenSaver()
 			mVideoScreensaver->onShow();
 			PowerSaver::runningScreenSaver(true);
 			mTimer = 0;
+			pickNextItem();
 			return;
 		}
 	}
@@ -128,18 +117,9 @@ void SystemScreenSaver::startScreenSaver()
 		mVideoChangeTime = Settings::getInstance()->getInt("ScreenSaverSwapImageTimeout");
 		mOpacity = 0.0f;
 
-		// Load a random image
+		// Load a random image, the one picked while the previous one was showing if there is one
 		std::string path = "";
-		if (Settings::getInstance()->getBool("SlideshowScreenSaverCustomImageSource"))
-		{
-			pickRandomCustomImage(path);
-			// Custom images are not tied to the game list
-			mCurrentGame = NULL;
-		}
-		else
-		{
-			pickRandomGameListImage(path);
-		}
+		takeNextItem(path);
 
 		if (!mImageScreensaver)
 		{
@@ -148,7 +128,6 @@ void SystemScreenSaver::startScreenSaver()
 
 		mTimer = 0;
 
-		mImageScreensaver->setImage(path);
 		mImageScreensaver->setOrigin(0.5f, 0.5f);
 		mImageScreensaver->setPosition(Renderer::getScreenWidth() / 2.0f, Renderer::getScreenHeight() / 2.0f);
 
@@ -161,6 +140,10 @@ void SystemScreenSaver::startScreenSaver()
 			mImageScreensaver->setMaxSize((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 		}
 
+		// Sized first, so it picks up the texture that was prefetched at this size
+		mImageScreensaver->setImage(path);
+		pickNextItem();
+
 		std::string bg_audio_file = Settings::getInstance()->getString("SlideshowScreenSaverBackgroundAudioFile");
 		if ((!mBackgroundAudio) && (bg_audio_file != ""))
 		{
@@ -192,6 +175,14 @@ void SystemScreenSaver::stopScreenSaver()
 		PowerSaver::resume();
 	}
 
+	// Only keep the next item when going straight on to it, the games could change while the screensaver is off
+	if (mStopBackgroundAudio)
+	{
+		mNextPath.clear();
+		mNextGame = NULL;
+		mNextImage.reset();
+	}
+
 	// so that we stop the background audio next time, unless we're restarting the screensaver
 	mStopBackgroundAudio = true;
 
@@ -256,160 +247,71 @@ void SystemScreenSaver::renderScreenSaver()
 	}
 }
 
-unsigned long SystemScreenSaver::countGameListNodes(const char *nodeName)
+void SystemScreenSaver::pickNextItem()
 {
-	unsigned long nodeCount = 0;
-	std::vector<SystemData*>::const_iterator it;
-	for (it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); ++it)
+	mNextPath.clear();
+	mNextGame = NULL;
+	mNextImage.reset();
+
+	if (Settings::getInstance()->getString("ScreenSaverBehavior") == "random video")
 	{
-		// We only want images and videos from game systems that are not collections
-		if (!(*it)->isCollection() && (*it)->isGameSystem())
-		{
-			pugi::xml_document doc;
-			pugi::xml_node root;
-			std::string xmlReadPath = (*it)->getGamelistPath(false);
+		pickGameListMedia(MediaIndex::MEDIA_VIDEO);
 
-			if(Utils::FileSystem::exists(xmlReadPath))
-			{
-				pugi::xml_parse_result result = doc.load_file(xmlReadPath.c_str());
-				if (!result)
-					continue;
-				root = doc.child("gameList");
-				if (!root)
-					continue;
-				for(pugi::xml_node fileNode = root.child("game"); fileNode; fileNode = fileNode.next_sibling("game"))
-				{
-					pugi::xml_node node = fileNode.child(nodeName);
-					if (node)
-						++nodeCount;
-				}
-			}
-		}
+		// Parse it while this one plays, so it starts right away when it's its turn
+		if (!mNextPath.empty())
+			VideoVlcComponent::prefetchVideo(mNextPath);
 	}
-	return nodeCount;
-}
-
-void SystemScreenSaver::countVideos()
-{
-	if (!mVideosCounted)
+	else
 	{
-		mVideoCount = countGameListNodes("video");
-		mVideosCounted = true;
-	}
-}
+		// Custom images are not tied to the game list
+		if (Settings::getInstance()->getBool("SlideshowScreenSaverCustomImageSource"))
+			pickRandomCustomImage(mNextPath);
+		else
+			pickGameListMedia(MediaIndex::MEDIA_IMAGE);
 
-void SystemScreenSaver::countImages()
-{
-	if (!mImagesCounted)
-	{
-		mImageCount = countGameListNodes("image");
-		mImagesCounted = true;
+		// Decode it while this one shows, behind anything the rest of the UI is waiting for
+		if (!mNextPath.empty() && mImageScreensaver)
+			mNextImage = mImageScreensaver->prefetchImage(mNextPath, TEXTURE_LOAD_BACKGROUND);
 	}
 }
 
-void SystemScreenSaver::pickGameListNode(unsigned long index, const char *nodeName, std::string& path)
+void SystemScreenSaver::takeNextItem(std::string& path)
 {
-	std::vector<SystemData*>::const_iterator it;
-	for (it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); ++it)
-	{
-		pugi::xml_document doc;
-		pugi::xml_node root;
+	if (mNextPath.empty())
+		pickNextItem();
 
-		// We only want nodes from game systems that are not collections
-		if (!(*it)->isGameSystem() || (*it)->isCollection())
-			continue;
+	// mNextImage is kept until the next pick, so the texture is still there when the image is set
+	path = mNextPath;
+	mCurrentGame = mNextGame;
+	mNextPath.clear();
+	mNextGame = NULL;
 
-		std::string xmlReadPath = (*it)->getGamelistPath(false);
-
-		if(Utils::FileSystem::exists(xmlReadPath))
-		{
-			pugi::xml_parse_result result = doc.load_file(xmlReadPath.c_str());
-			if (!result)
-				continue;
-			root = doc.child("gameList");
-			if (!root)
-				continue;
-			for(pugi::xml_node fileNode = root.child("game"); fileNode; fileNode = fileNode.next_sibling("game"))
-			{
-				pugi::xml_node node = fileNode.child(nodeName);
-				if (node)
-				{
-					// See if this is the desired index
-					if (index-- == 0)
-					{
-						// Yes. Resolve to a full path
-						path = Utils::FileSystem::resolveRelativePath(node.text().get(), (*it)->getStartPath(), true);
-						mSystemName = (*it)->getFullName();
-						mGameName = fileNode.child("name").text().get();
-
-						// getting corresponding FileData
-
-						// try the easy way. Should work for the majority of cases, unless in subfolders
-						FileData* rootFileData = (*it)->getRootFolder();
-						std::string gamePath = Utils::FileSystem::resolveRelativePath(fileNode.child("path").text().get(), (*it)->getStartPath(), false);
-
-						std::string shortPath = gamePath;
-						shortPath = shortPath.replace(0, (*it)->getStartPath().length()+1, "");
-
-						const std::unordered_map<std::string, FileData*>& children = rootFileData->getChildrenByFilename();
-						std::unordered_map<std::string, FileData*>::const_iterator screenSaverGame = children.find(shortPath);
-
-						if (screenSaverGame != children.cend())
-						{
-							// Found the corresponding FileData
-							mCurrentGame = screenSaverGame->second;
-						}
-						else
-						{
-							// Couldn't find FileData. Going for the full iteration.
-							// iterate on children
-							FileType type = GAME;
-							std::vector<FileData*> allFiles = rootFileData->getFilesRecursive(type);
-							std::vector<FileData*>::const_iterator itf;  // declare an iterator to a vector of strings
-
-							int i = 0;
-							for(itf=allFiles.cbegin() ; itf < allFiles.cend(); itf++,i++ ) {
-								if ((*itf)->getPath() == gamePath)
-								{
-									mCurrentGame = (*itf);
-									break;
-								}
-							}
-						}
-
-						// end of getting FileData
-						if (Settings::getInstance()->getString("ScreenSaverGameInfo") != "never")
-							writeSubtitle(mGameName.c_str(), mSystemName.c_str(),
-								(Settings::getInstance()->getString("ScreenSaverGameInfo") == "always"));
-						return;
-					}
-				}
-			}
-		}
-	}
-}
-
-void SystemScreenSaver::pickRandomVideo(std::string& path)
-{
-	countVideos();
-	mCurrentGame = NULL;
-	if (mVideoCount > 0)
+	if (mCurrentGame != NULL)
 	{
-		int video = (int)(((float)rand() / float(RAND_MAX)) * (float)mVideoCount);
+		mSystemName = mCurrentGame->getSystem()->getFullName();
+		mGameName = mCurrentGame->getName();
 
-		pickGameListNode(video, "video", path);
+		if (Settings::getInstance()->getString("ScreenSaverGameInfo") != "never")
+			writeSubtitle(mGameName.c_str(), mSystemName.c_str(),
+				(Settings::getInstance()->getString("ScreenSaverGameInfo") == "always"));
 	}
 }
 
-void SystemScreenSaver::pickRandomGameListImage(std::string& path)
+void SystemScreenSaver::pickGameListMedia(MediaIndex::MediaType type)
 {
-	countImages();
-	mCurrentGame = NULL;
-	if (mImageCount > 0)
+	// The gamelists can still point at files that were deleted since
+	for (int retry = 200; retry > 0; retry--)
 	{
-		int image = (int)(((float)rand() / float(RAND_MAX)) * (float)mImageCount);
+		const MediaIndex::Entry* entry = MediaIndex::getInstance()->pickRandom(type);
+		if (entry == NULL)
+			return;
 
-		pickGameListNode(image, "image", path);
+		if (Utils::FileSystem::exists(entry->path))
+		{
+			mNextPath = entry->path;
+			mNextGame = entry->file;
+			return;
+		}
 	}
 }
 
@@ -459,6 +361,7 @@ void SystemScreenSaver::update(int deltaTime)
 	// Use this to update the fade value for the current fade stage
 	if (mState == STATE_FADE_OUT_WINDOW)
 	{
+		mWindow->invalidate();
 		mOpacity += (float)deltaTime / FADE_TIME;
 		if (mOpacity >= 1.0f)
 		{
@@ -470,6 +373,7 @@ void SystemScreenSaver::update(int deltaTime)
 	}
 	else if (mState == STATE_FADE_IN_VIDEO)
 	{
+		mWindow->invalidate();
 		mOpacity -= (float)deltaTime / FADE_TIME;
 		if (mOpacity <= 0.0f)
 		{
@@ -500,6 +404,7 @@ void SystemScreenSaver::nextVideo() {
 	stopScreenSaver();
 	startScreenSaver();
 	mState = STATE_SCREENSAVER_ACTIVE;
+	mWindow->invalidate();
 }
 
 FileData* SystemScreenSaver::getCurrentGame()
@@ -2,10 +2,12 @@
 #ifndef ES_APP_SYSTEM_SCREEN_SAVER_H
 #define ES_APP_SYSTEM_SCREEN_SAVER_H
 
+#include "MediaIndex.h"
 #include "Window.h"
 
 class ImageComponent;
 class Sound;
+class TextureResource;
 class VideoComponent;
 
 // Screensaver implementation for main window
@@ -27,12 +29,11 @@ public:
 	virtual void launchGame();
 
 private:
-	unsigned long countGameListNodes(const char *nodeName);
-	void countVideos();
-	void countImages();
-	void pickGameListNode(unsigned long index, const char *nodeName, std::string& path);
-	void pickRandomVideo(std::string& path);
-	void pickRandomGameListImage(std::string& path);
+	// Picks what's shown after the current item and starts loading it
+	void pickNextItem();
+	// Makes the next item the current one, picking it now if that wasn't done yet
+	void takeNextItem(std::string& path);
+	void pickGameListMedia(MediaIndex::MediaType type);
 	void pickRandomCustomImage(std::string& path);
 
 	void input(InputConfig* config, Input input);
@@ -45,17 +46,16 @@ private:
 	};
 
 private:
-	bool			mVideosCounted;
-	unsigned long		mVideoCount;
 	VideoComponent*		mVideoScreensaver;
-	bool			mImagesCounted;
-	unsigned long		mImageCount;
 	ImageComponent*		mImageScreensaver;
 	Window*			mWindow;
 	STATE			mState;
 	float			mOpacity;
 	int				mTimer;
 	FileData*		mCurrentGame;
+	FileData*		mNextGame;
+	std::string		mNextPath;
+	std::shared_ptr<TextureResource>	mNextImage;
 	std::string		mGameName;
 	std::string		mSystemName;
 	int 			mVideoChangeTime;
@@ -2,6 +2,7 @@
 
 #include "HttpReq.h"
 #include "Renderer.h"
+#include "Window.h"
 
 AsyncReqComponent::AsyncReqComponent(Window* window, std::shared_ptr<HttpReq> req, std::function<void(std::shared_ptr<HttpReq>)> onSuccess, std::function<void()> onCancel) 
 	: GuiComponent(window), 
@@ -33,6 +34,7 @@ void AsyncReqComponent::update(int deltaTime)
 	}
 
 	mTime += deltaTime;
+	mWindow->invalidate(); // the spinner
 }
 
 void AsyncReqComponent::render(const Transform4x4f& /*parentTrans*/)
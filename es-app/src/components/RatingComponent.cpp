@@ -115,6 +115,7 @@ void RatingComponent::render(const Transform4x4f& parentTrans)
 	Transform4x4f trans = parentTrans * getTransform();
 	trans.round();
 	Renderer::setMatrix(trans);
+	Renderer::flush();
 
 	glEnable(GL_TEXTURE_2D);
 	glEnable(GL_BLEND);
@@ -384,10 +384,13 @@ void ScraperSearchComponent::update(int deltaTime)
 	if(mThumbnailReq && mThumbnailReq->status() != HttpReq::REQ_IN_PROGRESS)
 	{
 		updateThumbnail();
+		mWindow->invalidate();
 	}
 
 	if(mSearchHandle && mSearchHandle->status() != ASYNC_IN_PROGRESS)
 	{
+		mWindow->invalidate();
+
 		auto status = mSearchHandle->status();
 		auto results = mSearchHandle->getResults();
 		auto statusString = mSearchHandle->getStatusString();
@@ -407,6 +410,8 @@ void ScraperSearchComponent::update(int deltaTime)
 
 	if(mMDResolveHandle && mMDResolveHandle->status() != ASYNC_IN_PROGRESS)
 	{
+		mWindow->invalidate();
+
 		if(mMDResolveHandle->status() == ASYNC_DONE)
 		{
 			ScraperSearchResult result = mMDResolveHandle->getResult();
@@ -29,6 +29,7 @@ protected:
 	using IList<TextListData, T>::getTransform;
 	using IList<TextListData, T>::mSize;
 	using IList<TextListData, T>::mCursor;
+	using IList<TextListData, T>::mWindow;
 	using IList<TextListData, T>::Entry;
 
 public:
@@ -292,6 +293,9 @@ void TextListComponent<T>::update(int deltaTime)
 
 	if(!isScrolling() && size() > 0)
 	{
+		const int lastOffset  = mMarqueeOffset;
+		const int lastOffset2 = mMarqueeOffset2;
+
 		// always reset the marquee offsets
 		mMarqueeOffset  = 0;
 		mMarqueeOffset2 = 0;
@@ -321,6 +325,10 @@ void TextListComponent<T>::update(int deltaTime)
 			if(mMarqueeOffset > (scrollLength - (limit - returnLength)))
 				mMarqueeOffset2 = (int)(mMarqueeOffset - (scrollLength + returnLength));
 		}
+
+		// only redraw while the marquee is actually moving, not during its delay
+		if(mMarqueeOffset != lastOffset || mMarqueeOffset2 != lastOffset2)
+			mWindow->invalidate();
 	}
 
 	GuiComponent::update(deltaTime);
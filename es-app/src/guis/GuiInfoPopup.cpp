@@ -4,6 +4,7 @@
 #include "components/NinePatchComponent.h"
 #include "components/TextComponent.h"
 #include "Renderer.h"
+#include "Window.h"
 #include <SDL_timer.h>
 
 GuiInfoPopup::GuiInfoPopup(Window* window, std::string message, int duration) :
@@ -72,6 +73,9 @@ void GuiInfoPopup::render(const Transform4x4f& /*parentTrans*/)
 		// if we're still supposed to be rendering it
 		Renderer::setMatrix(trans);
 		renderChildren(trans);
+
+		// it fades and times out on the clock, so keep rendering until it's gone
+		mWindow->invalidate();
 	}
 }
 
@@ -320,6 +320,12 @@ void GuiMenu::openOtherSettings()
 	s->addWithLabel("VRAM LIMIT", max_vram);
 	s->addSaveFunc([max_vram] { Settings::getInstance()->setInt("MaxVRAM", (int)Math::round(max_vram->getValue())); });
 
+	// texture RAM limit
+	auto max_texture_ram = std::make_shared<SliderComponent>(mWindow, 0.f, 1000.f, 10.f, "Mb");
+	max_texture_ram->setValue((float)(Settings::getInstance()->getInt("MaxTextureRAM")));
+	s->addWithLabel("TEXTURE RAM LIMIT", max_texture_ram);
+	s->addSaveFunc([max_texture_ram] { Settings::getInstance()->setInt("MaxTextureRAM", (int)Math::round(max_texture_ram->getValue())); });
+
 	// power saver
 	auto power_saver = std::make_shared< OptionListComponent<std::string> >(mWindow, "POWER SAVER MODES", false);
 	std::vector<std::string> modes;
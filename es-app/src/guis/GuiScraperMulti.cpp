@@ -6,7 +6,9 @@
 #include "components/TextComponent.h"
 #include "guis/GuiMsgBox.h"
 #include "views/ViewController.h"
-#include "Gamelist.h"
+#include "CollectionSystemManager.h"
+#include "FileFilterIndex.h"
+#include "MediaIndex.h"
 #include "PowerSaver.h"
 #include "SystemData.h"
 #include "Window.h"
@@ -113,8 +115,14 @@ void GuiScraperMulti::acceptResult(const ScraperSearchResult& result)
 {
 	ScraperSearchParams& search = mSearchQueue.front();
 
-	search.game->metadata = result.mdl;
-	updateGamelist(search.system);
+	// re-index the game's filter keys, in its system and in the collections it's in
+	FileData* game = search.game->getSourceFileData();
+	game->getSystem()->getIndex()->removeFromIndex(game);
+	game->metadata = result.mdl;
+	game->getSystem()->getIndex()->addToIndex(game);
+	CollectionSystemManager::get()->refreshCollectionSystems(game);
+	MediaIndex::getInstance()->onFileChanged(game, FILE_METADATA_CHANGED);
+	game->getSystem()->saveGamelistInBackground();
 
 	mSearchQueue.pop();
 	mCurrentGame++;
@@ -7,11 +7,13 @@
 #include "views/ViewController.h"
 #include "CollectionSystemManager.h"
 #include "EmulationStation.h"
+#include "FrameDriver.h"
 #include "InputManager.h"
 #include "Log.h"
 #include "MameNames.h"
 #include "platform.h"
 #include "PowerSaver.h"
+#include "Profiler.h"
 #include "ScraperCmdLine.h"
 #include "Settings.h"
 #include "SystemData.h"
@@ -27,6 +29,10 @@
 
 #include <FreeImage.h>
 
+// ms to wait for events after a frame where nothing changed, about a frame at 60Hz
+// so timers (marquee delays, held buttons, video frames) aren't noticeably late
+#define IDLE_WAIT_TIME 16
+
 bool scrape_cmdline = false;
 
 bool parseArgs(int argc, char* argv[])
@@ -91,6 +97,9 @@ bool parseArgs(int argc, char* argv[])
 		}else if(strcmp(argv[i], "--ignore-gamelist") == 0)
 		{
 			Settings::getInstance()->setBool("IgnoreGamelist", true);
+		}else if(strcmp(argv[i], "--rebuild-cache") == 0)
+		{
+			Settings::getInstance()->setBool("RebuildLibraryCache", true);
 		}else if(strcmp(argv[i], "--show-hidden-files") == 0)
 		{
 			Settings::getInstance()->setBool("ShowHiddenFiles", true);
@@ -123,6 +132,56 @@ bool parseArgs(int argc, char* argv[])
 		{
 			int maxVRAM = atoi(argv[i + 1]);
 			Settings::getInstance()->setInt("MaxVRAM", maxVRAM);
+		}else if(strcmp(argv[i], "--max-texture-ram") == 0)
+		{
+			int maxTextureRAM = atoi(argv[i + 1]);
+			Settings::getInstance()->setInt("MaxTextureRAM", maxTextureRAM);
+		}
+		else if(strcmp(argv[i], "--headless") == 0)
+		{
+			Settings::getInstance()->setBool("Headless", true);
+			Settings::getInstance()->setBool("SplashScreen", false);
+		}else if(strcmp(argv[i], "--frames") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid frame count supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setInt("BenchmarkFrames", atoi(argv[i + 1]));
+			++i; // skip the argument value
+		}else if(strcmp(argv[i], "--frame-time") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid frame time supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setInt("BenchmarkFrameTime", atoi(argv[i + 1]));
+			++i; // skip the argument value
+		}else if(strcmp(argv[i], "--trace-file") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid trace file supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setString("TraceFile", argv[i + 1]);
+			Profiler::setEnabled(true);
+			++i; // skip the argument value
+		}else if(strcmp(argv[i], "--input-script") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid input script supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setString("BenchmarkInputScript", argv[i + 1]);
+			++i; // skip the argument value
 		}
 		else if (strcmp(argv[i], "--force-kiosk") == 0)
 		{
@@ -150,6 +209,7 @@ bool parseArgs(int argc, char* argv[])
 				"--resolution [width] [height]	try and force a particular resolution\n"
 				"--gamelist-only			skip automatic game search, only read from gamelist.xml\n"
 				"--ignore-gamelist		ignore the gamelist (useful for troubleshooting)\n"
+				"--rebuild-cache			ignore the library cache and rebuild it from the rom folders and gamelists\n"
 				"--draw-framerate		display the framerate\n"
 				"--no-exit			don't show the exit option in the menu\n"
 				"--no-splash			don't show the splash screen\n"
@@ -158,7 +218,13 @@ bool parseArgs(int argc, char* argv[])
 				"--windowed			not fullscreen, should be used with --resolution\n"
 				"--vsync [1/on or 0/off]		turn vsync on or off (default is on)\n"
 				"--max-vram [size]		Max VRAM to use in Mb before swapping. 0 for unlimited\n"
+				"--max-texture-ram [size]	Max RAM to keep decoded images in, in Mb. 0 for unlimited\n"
 				"--force-kiosk		Force the UI mode to be Kiosk\n"
+				"--headless			render offscreen, no display needed\n"
+				"--frames [count]		run this many frames with scripted input, print how long they took and quit\n"
+				"--frame-time [ms]		time each of those frames advances by (default is 16)\n"
+				"--input-script [path]		input for those frames, lines of \"<frame> <input name>\"\n"
+				"--trace-file [path]		profile and write a Chrome trace of the last few seconds to path on exit\n"
 				"--help, -h			summon a sentient, angry tuba\n\n"
 				"More information available in README.md.\n";
 			return false; //exit after printing help
@@ -188,11 +254,11 @@ bool verifyHomeFolderExists()
 }
 
 // Returns true if everything is OK,
-bool loadSystemConfigFile(const char** errorString)
+bool loadSystemConfigFile(Window* window, const char** errorString)
 {
 	*errorString = NULL;
 
-	if(!SystemData::loadConfig())
+	if(!SystemData::loadConfig(window))
 	{
 		LOG(LogError) << "Error while parsing systems configuration file!";
 		*errorString = "IT LOOKS LIKE YOUR SYSTEMS CONFIGURATION FILE HAS NOT BEEN SET UP OR IS INVALID. YOU'LL NEED TO DO THIS BY HAND, UNFORTUNATELY.\n\n"
@@ -302,7 +368,8 @@ int main(int argc, char* argv[])
 	}
 
 	const char* errorMsg = NULL;
-	if(!loadSystemConfigFile(&errorMsg))
+	bool splashScreen = !scrape_cmdline && Settings::getInstance()->getBool("SplashScreen");
+	if(!loadSystemConfigFile(splashScreen ? &window : NULL, &errorMsg))
 	{
 		// something went terribly wrong
 		if(errorMsg == NULL)
@@ -336,10 +403,15 @@ int main(int argc, char* argv[])
 	// this makes for no delays when accessing content, but a longer startup time
 	ViewController::get()->preload();
 
+	// a benchmark's input script goes through the keyboard, so make sure it's mapped
+	const int benchmarkFrames = Settings::getInstance()->getInt("BenchmarkFrames");
+	if(benchmarkFrames > 0 && !InputManager::getInstance()->getInputConfigByDevice(DEVICE_KEYBOARD)->isConfigured())
+		InputManager::getInstance()->loadDefaultKBConfig();
+
 	//choose which GUI to open depending on if an input configuration already exists
 	if(errorMsg == NULL)
 	{
-		if(Utils::FileSystem::exists(InputManager::getConfigPath()) && InputManager::getInstance()->getNumConfiguredDevices() > 0)
+		if(benchmarkFrames > 0 || (Utils::FileSystem::exists(InputManager::getConfigPath()) && InputManager::getInstance()->getNumConfiguredDevices() > 0))
 		{
 			ViewController::get()->goToStart();
 		}else{
@@ -354,13 +426,25 @@ int main(int argc, char* argv[])
 	int ps_time = SDL_GetTicks();
 
 	bool running = true;
+	bool idle = false;
+
+	// run the benchmark then quit
+	if(benchmarkFrames > 0)
+	{
+		FrameDriver driver(&window);
+		const std::string script = Settings::getInstance()->getString("BenchmarkInputScript");
+		if(script.empty() || driver.loadScript(script))
+			driver.run((unsigned int)benchmarkFrames, Settings::getInstance()->getInt("BenchmarkFrameTime"));
+		running = false;
+	}
 
 	while(running)
 	{
 		SDL_Event event;
 		bool ps_standby = PowerSaver::getState() && (int) SDL_GetTicks() - ps_time > PowerSaver::getMode();
 
-		if(ps_standby ? SDL_WaitEventTimeout(&event, PowerSaver::getTimeout()) : SDL_PollEvent(&event))
+		if(ps_standby ? SDL_WaitEventTimeout(&event, PowerSaver::getTimeout()) :
+			idle ? SDL_WaitEventTimeout(&event, IDLE_WAIT_TIME) : SDL_PollEvent(&event))
 		{
 			do
 			{
@@ -368,6 +452,8 @@ int main(int argc, char* argv[])
 
 				if(event.type == SDL_QUIT)
 					running = false;
+				else if(event.type == SDL_WINDOWEVENT) // exposed, resized, ...
+					window.invalidate();
 			} while(SDL_PollEvent(&event));
 
 			// triggered if exiting from SDL_WaitEvent due to event
@@ -401,12 +487,25 @@ int main(int argc, char* argv[])
 			deltaTime = 1000;
 
 		window.update(deltaTime);
-		window.render();
-		Renderer::swapBuffers();
+
+		// only render when something changed, otherwise block on events until the next update
+		idle = !window.isInvalidated();
+		if(!idle)
+		{
+			window.render();
+			Renderer::swapBuffers();
+		}
 
 		Log::flush();
 	}
 
+	if(!Settings::getInstance()->getString("TraceFile").empty())
+		Profiler::writeTrace(Settings::getInstance()->getString("TraceFile"));
+
+	// a benchmark's scripted visits shouldn't decide which views warm up first next time
+	if(benchmarkFrames == 0)
+		ViewController::get()->saveVisitedSystems();
+
 	while(window.peekGui() != ViewController::get())
 		delete window.peekGui();
 	window.deinit();
@@ -5,6 +5,7 @@
 #include "animations/LaunchAnimation.h"
 #include "animations/MoveCameraAnimation.h"
 #include "guis/GuiMenu.h"
+#include "utils/FileSystemUtil.h"
 #include "views/gamelist/DetailedGameListView.h"
 #include "views/gamelist/IGameListView.h"
 #include "views/gamelist/VideoGameListView.h"
@@ -12,12 +13,22 @@
 #include "views/UIModeController.h"
 #include "FileFilterIndex.h"
 #include "Log.h"
+#include "MediaIndex.h"
 #include "Settings.h"
 #include "SystemData.h"
 #include "Window.h"
+#include <fstream>
+
+#define WARM_UP_IDLE_TIME 500 // ms without input before a view that wasn't visited yet is built
 
 ViewController* ViewController::sInstance = NULL;
 
+// one system name per line, most recently visited first
+static std::string getVisitedSystemsPath()
+{
+	return Utils::FileSystem::getHomePath() + "/.emulationstation/cache/visited_systems";
+}
+
 ViewController* ViewController::get()
 {
 	assert(sInstance);
@@ -31,7 +42,8 @@ void ViewController::init(Window* window)
 }
 
 ViewController::ViewController(Window* window)
-	: GuiComponent(window), mCurrentView(nullptr), mCamera(Transform4x4f::Identity()), mFadeOpacity(0), mLockInput(false)
+	: GuiComponent(window), mCurrentView(nullptr), mCamera(Transform4x4f::Identity()), mFadeOpacity(0), mLockInput(false),
+	mInputHeld(false), mTimeSinceInput(0)
 {
 	mState.viewing = NOTHING;
 }
@@ -126,6 +138,9 @@ void ViewController::goToGameList(SystemData* system)
 	mState.viewing = GAME_LIST;
 	mState.system = system;
 
+	mVisitedSystems.erase(std::remove(mVisitedSystems.begin(), mVisitedSystems.end(), system->getName()), mVisitedSystems.end());
+	mVisitedSystems.insert(mVisitedSystems.begin(), system->getName());
+
 	if (mCurrentView)
 	{
 		mCurrentView->onHide();
@@ -194,6 +209,12 @@ void ViewController::playViewTransition()
 
 void ViewController::onFileChanged(FileData* file, FileChangeType change)
 {
+	MediaIndex::getInstance()->onFileChanged(file, change);
+
+	// written while the user carries on, instead of all at once on exit
+	if(change == FILE_METADATA_CHANGED && Settings::getInstance()->getBool("SaveGamelistsOnExit"))
+		file->getSourceFileData()->getSystem()->saveGamelistInBackground();
+
 	auto it = mGameListViews.find(file->getSystem());
 	if(it != mGameListViews.cend())
 		it->second->onFileChanged(file, change);
@@ -219,6 +240,9 @@ void ViewController::launch(FileData* game, Vector3f center)
 	mWindow->stopInfoPopup(); // make sure we disable any existing info popup
 	mLockInput = true;
 
+	// in case ES doesn't get to exit cleanly after the game
+	saveVisitedSystems();
+
 	std::string transition_style = Settings::getInstance()->getString("TransitionStyle");
 	if(transition_style == "fade")
 	{
@@ -289,20 +313,12 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 
 	if (selectedViewType == AUTOMATIC)
 	{
-		std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME | FOLDER);
-		for (auto it = files.cbegin(); it != files.cend(); it++)
-		{
-			if (themeHasVideoView && !(*it)->getVideoPath().empty())
-			{
-				selectedViewType = VIDEO;
-				break;
-			}
-			else if (!(*it)->getThumbnailPath().empty())
-			{
-				selectedViewType = DETAILED;
-				// Don't break out in case any subsequent files have video
-			}
-		}
+		// detected when the system was loaded, rather than looking for every game's media now
+		const unsigned int media = system->getMediaFlags();
+		if (themeHasVideoView && (media & MEDIA_VIDEO))
+			selectedViewType = VIDEO;
+		else if (media & MEDIA_THUMBNAIL)
+			selectedViewType = DETAILED;
 	}
 
 	// Create the view
@@ -350,6 +366,10 @@ std::shared_ptr<SystemView> ViewController::getSystemListView()
 
 bool ViewController::input(InputConfig* config, Input input)
 {
+	// a held direction keeps scrolling without sending anything, so it counts as input until it's released
+	mInputHeld = (input.value != 0);
+	mTimeSinceInput = 0;
+
 	if(mLockInput)
 		return true;
 
@@ -380,6 +400,26 @@ void ViewController::update(int deltaTime)
 	}
 
 	updateSelf(deltaTime);
+
+	if(!mInputHeld && (mTimeSinceInput < WARM_UP_IDLE_TIME))
+		mTimeSinceInput += deltaTime;
+
+	// build one of the views that haven't been visited yet, but not while the user is navigating, in the middle of
+	// a transition or a launch
+	if(!mWarmUpQueue.empty() && (mTimeSinceInput >= WARM_UP_IDLE_TIME) && !isAnimationPlaying(0) && !mLockInput)
+	{
+		const std::string name = mWarmUpQueue.front();
+		mWarmUpQueue.pop_front();
+
+		for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
+		{
+			if((*it)->getName() == name)
+			{
+				getGameListView(*it);
+				break;
+			}
+		}
+	}
 }
 
 void ViewController::render(const Transform4x4f& parentTrans)
@@ -424,10 +464,55 @@ void ViewController::render(const Transform4x4f& parentTrans)
 void ViewController::preload()
 {
 	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
-	{
 		(*it)->getIndex()->resetFilters();
-		getGameListView(*it);
+
+	mVisitedSystems.clear();
+	std::ifstream file(getVisitedSystemsPath().c_str());
+	std::string name;
+	while(std::getline(file, name))
+	{
+		if(!name.empty())
+			mVisitedSystems.push_back(name);
+	}
+
+	queueWarmUp();
+}
+
+void ViewController::queueWarmUp()
+{
+	mWarmUpQueue.clear();
+
+	std::vector<std::string> names;
+	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
+	{
+		if(mGameListViews.find(*it) == mGameListViews.cend())
+			names.push_back((*it)->getName());
+	}
+
+	// the systems visited last time first, in the order they were visited, then the rest in carousel order
+	for(auto it = mVisitedSystems.cbegin(); it != mVisitedSystems.cend(); it++)
+	{
+		auto visited = std::find(names.begin(), names.end(), *it);
+		if(visited != names.end())
+		{
+			mWarmUpQueue.push_back(*visited);
+			names.erase(visited);
+		}
 	}
+	mWarmUpQueue.insert(mWarmUpQueue.end(), names.cbegin(), names.cend());
+}
+
+void ViewController::saveVisitedSystems()
+{
+	const std::string path = getVisitedSystemsPath();
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(path));
+
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+	for(auto it = mVisitedSystems.cbegin(); it != mVisitedSystems.cend(); it++)
+		file << *it << "\n";
+
+	if(file.fail())
+		LOG(LogWarning) << "Error writing \"" << path << "\"";
 }
 
 void ViewController::reloadGameListView(IGameListView* view, bool reloadTheme)
@@ -444,6 +529,7 @@ void ViewController::reloadGameListView(IGameListView* view, bool reloadTheme)
 			if(reloadTheme)
 				system->loadTheme();
 			system->getIndex()->setUIModeFilters();
+			system->detectMedia(); // it may have changed to be detailed
 			std::shared_ptr<IGameListView> newView = getGameListView(system);
 
 			// to counter having come from a placeholder
@@ -481,6 +567,17 @@ void ViewController::reloadAll()
 		getGameListView(it->first)->setCursor(it->second);
 	}
 
+	// the views that weren't built yet only need their themes, they'll be built in the background again
+	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
+	{
+		if(cursorMap.find(*it) == cursorMap.cend())
+		{
+			(*it)->loadTheme();
+			(*it)->getIndex()->resetFilters();
+		}
+	}
+	queueWarmUp();
+
 	// Rebuild SystemListView
 	mSystemListView.reset();
 	getSystemListView();
@@ -5,6 +5,7 @@
 #include "FileData.h"
 #include "GuiComponent.h"
 #include "Renderer.h"
+#include <deque>
 #include <vector>
 
 class IGameListView;
@@ -20,10 +21,13 @@ public:
 
 	virtual ~ViewController();
 
-	// Try to completely populate the GameListView map.
-	// Caches things so there's no pauses during transitions.
+	// Queues every system's gamelist view to be built in the background, one per update, the
+	// most recently visited systems first. A view that's needed before then is built right away.
 	void preload();
 
+	// Remembers the order the gamelists were visited in for the next preload().
+	void saveVisitedSystems();
+
 	// If a basic view detected a metadata change, it can request to recreate
 	// the current gamelist view (as it may change to be detailed).
 	void reloadGameListView(IGameListView* gamelist, bool reloadTheme = false);
@@ -91,6 +95,7 @@ private:
 
 	void playViewTransition();
 	int getSystemId(SystemData* system);
+	void queueWarmUp(); // queue the views that haven't been built yet
 	
 	std::shared_ptr<GuiComponent> mCurrentView;
 	std::map< SystemData*, std::shared_ptr<IGameListView> > mGameListViews;
@@ -99,6 +104,11 @@ private:
 	Transform4x4f mCamera;
 	float mFadeOpacity;
 	bool mLockInput;
+	bool mInputHeld;
+	int mTimeSinceInput; // ms, not counting while input is held
+
+	std::vector<std::string> mVisitedSystems; // system names, most recently visited first
+	std::deque<std::string> mWarmUpQueue; // system names whose views still have to be built
 
 	State mState;
 };
@@ -27,6 +27,11 @@ void BasicGameListView::onThemeChanged(const std::shared_ptr<ThemeData>& theme)
 	sortChildren();
 }
 
+void BasicGameListView::prefetchUpcomingImages()
+{
+	prefetchImages(mList.getUpcoming(Settings::getInstance()->getInt("ImagePrefetchCount")));
+}
+
 void BasicGameListView::onFileChanged(FileData* file, FileChangeType change)
 {
 	if(change == FILE_METADATA_CHANGED)
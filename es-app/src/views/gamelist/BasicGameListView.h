@@ -27,6 +27,8 @@ protected:
 	virtual void populateList(const std::vector<FileData*>& files) override;
 	virtual void remove(FileData* game, bool deleteFile) override;
 	virtual void addPlaceholder();
+	// Prefetches the images of the games the cursor is likely to move to next
+	void prefetchUpcomingImages();
 
 	TextListComponent<FileData*> mList;
 };
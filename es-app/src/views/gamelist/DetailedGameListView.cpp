@@ -21,7 +21,7 @@ DetailedGameListView::DetailedGameListView(Window* window, FileData* root) :
 	mList.setPosition(mSize.x() * (0.50f + padding), mList.getPosition().y());
 	mList.setSize(mSize.x() * (0.50f - padding), mList.getSize().y());
 	mList.setAlignment(TextListComponent<FileData*>::ALIGN_LEFT);
-	mList.setCursorChangedCallback([&](const CursorState& /*state*/) { updateInfoPanel(); });
+	mList.setCursorChangedCallback([&](const CursorState& /*state*/) { updateInfoPanel(); prefetchUpcomingImages(); });
 
 	// image
 	mImage.setOrigin(0.5f, 0.5f);
@@ -179,6 +179,11 @@ void DetailedGameListView::initMDValues()
 	mDescContainer.setSize(mDescContainer.getSize().x(), mSize.y() - mDescContainer.getPosition().y());
 }
 
+void DetailedGameListView::prefetchGameImages(FileData* file, std::vector< std::shared_ptr<TextureResource> >& textures)
+{
+	textures.push_back(mImage.prefetchImage(file->getImagePath()));
+}
+
 void DetailedGameListView::updateInfoPanel()
 {
 	FileData* file = (mList.size() == 0 || mList.isScrolling()) ? NULL : mList.getSelected();
@@ -18,6 +18,9 @@ public:
 
 	virtual void launch(FileData* game) override;
 
+protected:
+	virtual void prefetchGameImages(FileData* file, std::vector< std::shared_ptr<TextureResource> >& textures) override;
+
 private:
 	void updateInfoPanel();
 
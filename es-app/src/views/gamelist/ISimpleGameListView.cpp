@@ -1,5 +1,6 @@
 #include "views/gamelist/ISimpleGameListView.h"
 
+#include "resources/TextureResource.h"
 #include "views/UIModeController.h"
 #include "views/ViewController.h"
 #include "CollectionSystemManager.h"
@@ -167,3 +168,23 @@ bool ISimpleGameListView::input(InputConfig* config, Input input)
 
 
 
+
+void ISimpleGameListView::prefetchImages(const std::vector<FileData*>& files)
+{
+	std::map< FileData*, std::vector< std::shared_ptr<TextureResource> > > prefetched;
+	for(auto it = files.cbegin(); it != files.cend(); it++)
+	{
+		// games that were already around the cursor keep what they had queued
+		auto found = mPrefetched.find(*it);
+		if(found != mPrefetched.cend())
+		{
+			prefetched[*it] = found->second;
+			continue;
+		}
+
+		prefetchGameImages(*it, prefetched[*it]);
+	}
+
+	// textures that aren't around the cursor anymore are released, and taken off the loader queue, here
+	mPrefetched.swap(prefetched);
+}
@@ -5,8 +5,11 @@
 #include "components/ImageComponent.h"
 #include "components/TextComponent.h"
 #include "views/gamelist/IGameListView.h"
+#include <map>
 #include <stack>
 
+class TextureResource;
+
 class ISimpleGameListView : public IGameListView
 {
 public:
@@ -30,6 +33,11 @@ public:
 protected:
 	virtual void populateList(const std::vector<FileData*>& files) = 0;
 
+	// Starts loading the images this view shows for a game, used for the games around the cursor
+	virtual void prefetchGameImages(FileData* /*file*/, std::vector< std::shared_ptr<TextureResource> >& /*textures*/) {}
+	// Keeps the images of files queued for loading in the background and lets go of the ones of any other file
+	void prefetchImages(const std::vector<FileData*>& files);
+
 	TextComponent mHeaderText;
 	ImageComponent mHeaderImage;
 	ImageComponent mBackground;
@@ -37,6 +45,8 @@ protected:
 	std::vector<GuiComponent*> mThemeExtras;
 
 	std::stack<FileData*> mCursorStack;
+
+	std::map< FileData*, std::vector< std::shared_ptr<TextureResource> > > mPrefetched;
 };
 
 #endif // ES_APP_VIEWS_GAME_LIST_ISIMPLE_GAME_LIST_VIEW_H
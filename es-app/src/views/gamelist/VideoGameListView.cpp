@@ -40,7 +40,7 @@ VideoGameListView::VideoGameListView(Window* window, FileData* root) :
 	mList.setPosition(mSize.x() * (0.50f + padding), mList.getPosition().y());
 	mList.setSize(mSize.x() * (0.50f - padding), mList.getSize().y());
 	mList.setAlignment(TextListComponent<FileData*>::ALIGN_LEFT);
-	mList.setCursorChangedCallback([&](const CursorState& /*state*/) { updateInfoPanel(); });
+	mList.setCursorChangedCallback([&](const CursorState& /*state*/) { updateInfoPanel(); prefetchUpcomingImages(); });
 
 	// Marquee
 	mMarquee.setOrigin(0.5f, 0.5f);
@@ -220,6 +220,13 @@ void VideoGameListView::initMDValues()
 
 
 
+void VideoGameListView::prefetchGameImages(FileData* file, std::vector< std::shared_ptr<TextureResource> >& textures)
+{
+	textures.push_back(mVideo->prefetchImage(file->getThumbnailPath()));
+	textures.push_back(mMarquee.prefetchImage(file->getMarqueePath()));
+	textures.push_back(mImage.prefetchImage(file->getImagePath()));
+}
+
 void VideoGameListView::updateInfoPanel()
 {
 	FileData* file = (mList.size() == 0 || mList.isScrolling()) ? NULL : mList.getSelected();
@@ -24,6 +24,7 @@ public:
 
 protected:
 	virtual void update(int deltaTime) override;
+	virtual void prefetchGameImages(FileData* file, std::vector< std::shared_ptr<TextureResource> >& textures) override;
 
 private:
 	void updateInfoPanel();
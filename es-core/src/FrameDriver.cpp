@@ -0,0 +1,153 @@
+#include "FrameDriver.h"
+
+#include "components/VideoComponent.h"
+#include "resources/TextureResource.h"
+#include "InputManager.h"
+#include "Log.h"
+#include "Renderer.h"
+#include "Window.h"
+#include <SDL_events.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+FrameDriver::FrameDriver(Window* window) : mWindow(window)
+{
+}
+
+bool FrameDriver::loadScript(const std::string& path)
+{
+	std::ifstream file(path.c_str());
+	if(!file.is_open())
+	{
+		LOG(LogError) << "Could not open input script \"" << path << "\"!";
+		return false;
+	}
+
+	std::string line;
+	unsigned int lineNumber = 0;
+	while(std::getline(file, line))
+	{
+		lineNumber++;
+
+		const size_t comment = line.find('#');
+		if(comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream stream(line);
+		unsigned int frame;
+		std::string name;
+		if(!(stream >> frame))
+			continue; // blank line
+
+		if(!(stream >> name))
+		{
+			LOG(LogError) << "Input script \"" << path << "\" line " << lineNumber << " has no input name!";
+			return false;
+		}
+
+		mScript[frame].push_back(name);
+	}
+
+	return true;
+}
+
+void FrameDriver::sendInput(const std::string& name, int value)
+{
+	InputConfig* config = InputManager::getInstance()->getInputConfigByDevice(DEVICE_KEYBOARD);
+	Input input;
+	if(!config->getInputByName(name, &input))
+	{
+		LOG(LogWarning) << "Input script uses \"" << name << "\" but the keyboard has nothing mapped to it";
+		return;
+	}
+
+	input.value = value;
+	mWindow->input(config, input);
+}
+
+void FrameDriver::run(unsigned int frames, int frameTime)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	LOG(LogInfo) << "Running " << frames << " frames of " << frameTime << "ms";
+
+	// Texture workers and video decoders run next to the frames on their own clock, which would make what a frame
+	// draws depend on timing. Videos stay on their static image, textures are finished before the next frame.
+	VideoComponent::setPlaybackDisabled(true);
+
+	std::vector<double> updateTimes;
+	std::vector<double> renderTimes;
+	std::vector<double> loadTimes;
+	updateTimes.reserve(frames);
+	renderTimes.reserve(frames);
+	loadTimes.reserve(frames);
+
+	std::vector<std::string> released;
+	const Clock::time_point start = Clock::now();
+
+	for(unsigned int frame = 0; frame < frames; frame++)
+	{
+		// the script is the only input, whatever the devices send is dropped
+		SDL_Event event;
+		while(SDL_PollEvent(&event))
+		{
+		}
+
+		for(auto it = released.cbegin(); it != released.cend(); it++)
+			sendInput(*it, 0);
+		released.clear();
+
+		auto scripted = mScript.find(frame);
+		if(scripted != mScript.cend())
+		{
+			for(auto it = scripted->second.cbegin(); it != scripted->second.cend(); it++)
+				sendInput(*it, 1);
+			released = scripted->second;
+		}
+
+		const Clock::time_point frameStart = Clock::now();
+		mWindow->update(frameTime);
+		const Clock::time_point updated = Clock::now();
+		mWindow->render();
+		Renderer::swapBuffers();
+		const Clock::time_point rendered = Clock::now();
+		TextureResource::waitForLoads();
+		const Clock::time_point loaded = Clock::now();
+
+		updateTimes.push_back(std::chrono::duration<double, std::milli>(updated - frameStart).count());
+		renderTimes.push_back(std::chrono::duration<double, std::milli>(rendered - updated).count());
+		loadTimes.push_back(std::chrono::duration<double, std::milli>(loaded - rendered).count());
+
+		Log::flush();
+	}
+
+	const double total = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	std::stringstream ss;
+	ss << "Ran " << frames << " frames in " << total << "ms";
+	if(frames)
+		ss << ", " << (frames * 1000.0 / total) << " fps";
+
+	const std::vector<double>* times[] = { &updateTimes, &renderTimes, &loadTimes };
+	const char* names[] = { "update", "render", "texture loads" };
+	for(int i = 0; i < 3; i++)
+	{
+		std::vector<double> sorted = *times[i];
+		if(sorted.empty())
+			continue;
+
+		std::sort(sorted.begin(), sorted.end());
+		double sum = 0;
+		for(auto it = sorted.cbegin(); it != sorted.cend(); it++)
+			sum += *it;
+
+		ss << "\n  " << names[i] << ": avg " << (sum / sorted.size()) << "ms, min " << sorted.front() << "ms, median " <<
+			sorted[sorted.size() / 2] << "ms, 95th " << sorted[(sorted.size() * 95) / 100] << "ms, max " << sorted.back() << "ms";
+	}
+
+	LOG(LogInfo) << ss.str();
+	std::cout << ss.str() << "\n";
+}
@@ -0,0 +1,32 @@
+#pragma once
+#ifndef ES_CORE_FRAME_DRIVER_H
+#define ES_CORE_FRAME_DRIVER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+class Window;
+
+// Runs the Window for a fixed number of frames with a fixed frame time instead of the wall clock, and prints
+// how long they took. Used for benchmarking, usually along with --headless.
+// So two runs draw the same frames, videos stay on their static image and the textures a frame asked for are
+// loaded before the next one starts.
+// Input comes from a script instead of the devices. Each line is "<frame> <input name>", the input
+// ("up", "a", "pagedown", ...) is pressed on that frame and released on the next. '#' starts a comment.
+class FrameDriver
+{
+public:
+	FrameDriver(Window* window);
+
+	bool loadScript(const std::string& path);
+	void run(unsigned int frames, int frameTime);
+
+private:
+	void sendInput(const std::string& name, int value);
+
+	Window* mWindow;
+	std::map< unsigned int, std::vector<std::string> > mScript;
+};
+
+#endif // ES_CORE_FRAME_DRIVER_H
@@ -3,10 +3,12 @@
 #include "animations/Animation.h"
 #include "animations/AnimationController.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include "ThemeData.h"
 #include "Window.h"
 #include <algorithm>
+#include <typeinfo>
 
 GuiComponent::GuiComponent(Window* window) : mWindow(window), mParent(NULL), mOpacity(255),
 	mPosition(Vector3f::Zero()), mOrigin(Vector2f::Zero()), mRotationOrigin(0.5, 0.5),
@@ -50,7 +52,9 @@ void GuiComponent::updateChildren(int deltaTime)
 {
 	for(unsigned int i = 0; i < getChildCount(); i++)
 	{
-		getChild(i)->update(deltaTime);
+		GuiComponent* child = getChild(i);
+		Profiler::ScopedTimer timer("update", typeid(*child).name());
+		child->update(deltaTime);
 	}
 }
 
@@ -70,7 +74,9 @@ void GuiComponent::renderChildren(const Transform4x4f& transform) const
 {
 	for(unsigned int i = 0; i < getChildCount(); i++)
 	{
-		getChild(i)->render(transform);
+		GuiComponent* child = getChild(i);
+		Profiler::ScopedTimer timer("render", typeid(*child).name());
+		child->render(transform);
 	}
 }
 
@@ -338,6 +344,7 @@ bool GuiComponent::finishAnimation(unsigned char slot)
 
 		delete mAnimationMap[slot]; // will also call finishedCallback
 		mAnimationMap[slot] = NULL;
+		mWindow->invalidate();
 		return true;
 	}else{
 		return false;
@@ -350,6 +357,9 @@ bool GuiComponent::advanceAnimation(unsigned char slot, unsigned int time)
 	AnimationController* anim = mAnimationMap[slot];
 	if(anim)
 	{
+		// a running animation changes something on screen every frame
+		mWindow->invalidate();
+
 		bool done = anim->update(time);
 		if(done)
 		{
@@ -30,6 +30,7 @@ public:
 	virtual bool input(InputConfig* config, Input input);
 
 	//Called when time passes.  Default implementation calls updateSelf(deltaTime) and updateChildren(deltaTime) - so you should probably call GuiComponent::update(deltaTime) at some point (or at least updateSelf so animations work).
+	//Frames are only rendered when something changed. Input and animations are taken care of, anything else that changes what's on screen over time (video frames, scrolling, timers) has to call mWindow->invalidate().
 	virtual void update(int deltaTime);
 
 	//Called when it's time to render.  By default, just calls renderChildren(parentTrans * getTransform()).
@@ -1,6 +1,7 @@
 #include "ImageIO.h"
 
 #include "Log.h"
+#include <algorithm>
 #include <FreeImage.h>
 #include <string.h>
 
@@ -88,3 +89,40 @@ void ImageIO::flipPixelsVert(unsigned char* imagePx, const size_t& width, const
 		}
 	}
 }
+
+std::vector<unsigned char> ImageIO::scaleDownRGBA32(const unsigned char* imagePx, const size_t& width, const size_t& height, const size_t& newWidth, const size_t& newHeight)
+{
+	std::vector<unsigned char> scaled(newWidth * newHeight * 4);
+	for (size_t y = 0; y < newHeight; y++)
+	{
+		const size_t srcY0 = y * height / newHeight;
+		const size_t srcY1 = std::max(srcY0 + 1, (y + 1) * height / newHeight);
+		for (size_t x = 0; x < newWidth; x++)
+		{
+			const size_t srcX0 = x * width / newWidth;
+			const size_t srcX1 = std::max(srcX0 + 1, (x + 1) * width / newWidth);
+
+			// colors are weighted by their alpha so transparent pixels don't darken the edges
+			unsigned long long r = 0, g = 0, b = 0, a = 0;
+			for (size_t srcY = srcY0; srcY < srcY1; srcY++)
+			{
+				const unsigned char* px = imagePx + ((srcY * width) + srcX0) * 4;
+				for (size_t srcX = srcX0; srcX < srcX1; srcX++, px += 4)
+				{
+					r += px[0] * px[3];
+					g += px[1] * px[3];
+					b += px[2] * px[3];
+					a += px[3];
+				}
+			}
+
+			const unsigned long long count = (srcX1 - srcX0) * (srcY1 - srcY0);
+			unsigned char* out = &scaled[((y * newWidth) + x) * 4];
+			out[0] = a ? (unsigned char)(r / a) : 0;
+			out[1] = a ? (unsigned char)(g / a) : 0;
+			out[2] = a ? (unsigned char)(b / a) : 0;
+			out[3] = (unsigned char)(a / count);
+		}
+	}
+	return scaled;
+}
@@ -10,6 +10,8 @@ class ImageIO
 public:
 	static std::vector<unsigned char> loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height);
 	static void flipPixelsVert(unsigned char* imagePx, const size_t& width, const size_t& height);
+	// Scales an image down by averaging every source pixel that falls into a destination pixel
+	static std::vector<unsigned char> scaleDownRGBA32(const unsigned char* imagePx, const size_t& width, const size_t& height, const size_t& newWidth, const size_t& newHeight);
 };
 
 #endif // ES_CORE_IMAGE_IO
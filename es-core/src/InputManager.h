@@ -19,8 +19,6 @@ private:
 
 	static const int DEADZONE = 23000;
 
-	void loadDefaultKBConfig();
-
 	std::map<SDL_JoystickID, SDL_Joystick*> mJoysticks;
 	std::map<SDL_JoystickID, InputConfig*> mInputConfigs;
 	InputConfig* mKeyboardInputConfig;
@@ -54,6 +52,7 @@ public:
 	std::string getDeviceGUIDString(int deviceId);
 
 	InputConfig* getInputConfigByDevice(int deviceId);
+	void loadDefaultKBConfig(); // maps the arrow keys, enter, escape, F1, F2 and the brackets
 
 	bool parseEvent(const SDL_Event& ev, Window* window);
 };
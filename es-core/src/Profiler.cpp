@@ -0,0 +1,210 @@
+#include "Profiler.h"
+
+#include "Log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#ifdef __GNUC__
+#include <cxxabi.h>
+#include <stdlib.h>
+#endif
+
+// events kept, a few seconds worth with a busy theme
+#define PROFILER_CAPACITY (256 * 1024)
+
+namespace Profiler
+{
+	struct Event
+	{
+		const char* category;
+		const char* name;
+		long long   start;    // microseconds
+		long long   duration; // microseconds
+		int         thread;
+	};
+
+	static std::atomic<bool>                sEnabled(false);
+	static std::mutex                       sMutex;
+	static std::vector<Event>               sEvents;
+	static size_t                           sNext = 0;
+	static bool                             sWrapped = false;
+	static std::map<std::thread::id, int>   sThreads;
+	static const std::thread::id            sMainThread = std::this_thread::get_id();
+
+	static long long now()
+	{
+		static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	// typeid() names are mangled with GCC and clang
+	static std::string getReadableName(const char* name)
+	{
+#ifdef __GNUC__
+		int status = 0;
+		char* demangled = abi::__cxa_demangle(name, NULL, NULL, &status);
+		if(demangled != NULL)
+		{
+			std::string result = (status == 0) ? demangled : name;
+			free(demangled);
+			return result;
+		}
+#endif
+		return name;
+	}
+
+	static std::string escapeJson(const std::string& text)
+	{
+		std::string escaped;
+		for(auto it = text.cbegin(); it != text.cend(); it++)
+		{
+			if((*it == '"') || (*it == '\\'))
+				escaped += '\\';
+			escaped += *it;
+		}
+		return escaped;
+	}
+
+	ScopedTimer::ScopedTimer(const char* category, const char* name) : mCategory(category), mName(name), mStart(-1)
+	{
+		if(sEnabled)
+			mStart = now();
+	}
+
+	ScopedTimer::~ScopedTimer()
+	{
+		if(mStart < 0 || !sEnabled)
+			return;
+
+		const long long duration = now() - mStart;
+		const std::thread::id threadId = std::this_thread::get_id();
+
+		std::unique_lock<std::mutex> lock(sMutex);
+		if(sEvents.empty())
+			return;
+
+		auto thread = sThreads.find(threadId);
+		if(thread == sThreads.cend())
+			thread = sThreads.insert(std::make_pair(threadId, (threadId == sMainThread) ? 0 : (int)sThreads.size() + 1)).first;
+
+		Event& event = sEvents[sNext];
+		event.category = mCategory;
+		event.name = mName;
+		event.start = mStart;
+		event.duration = duration;
+		event.thread = thread->second;
+
+		sNext = (sNext + 1) % sEvents.size();
+		if(sNext == 0)
+			sWrapped = true;
+	}
+
+	void setEnabled(bool enabled)
+	{
+		if(enabled == sEnabled)
+			return;
+
+		std::unique_lock<std::mutex> lock(sMutex);
+		if(enabled)
+		{
+			sEvents.resize(PROFILER_CAPACITY);
+		}
+		else
+		{
+			std::vector<Event>().swap(sEvents);
+			sNext = 0;
+			sWrapped = false;
+		}
+		sEnabled = enabled;
+	}
+
+	bool isEnabled()
+	{
+		return sEnabled;
+	}
+
+	std::vector<Total> getTotals(unsigned int period, size_t count)
+	{
+		std::map< std::pair<const char*, const char*>, Total > totals;
+		const long long since = now() - (long long)period * 1000;
+		const int mainThread = 0;
+
+		{
+			std::unique_lock<std::mutex> lock(sMutex);
+			const size_t used = sWrapped ? sEvents.size() : sNext;
+
+			// events are added when they end, so going from newest to oldest one that started before the period
+			// comes before the shorter ones it contains. Whatever ended during the period counts, wherever it is.
+			for(size_t i = 0; i < used; i++)
+			{
+				const Event& event = sEvents[(sNext + sEvents.size() - 1 - i) % sEvents.size()];
+				if((event.thread != mainThread) || (event.start + event.duration < since))
+					continue;
+
+				Total& total = totals[std::make_pair(event.category, event.name)];
+				total.milliseconds += event.duration / 1000.0;
+				total.count++;
+			}
+		}
+
+		std::vector<Total> sorted;
+		for(auto it = totals.begin(); it != totals.end(); it++)
+		{
+			it->second.name = getReadableName(it->first.second);
+			it->second.category = it->first.first;
+			sorted.push_back(it->second);
+		}
+
+		std::sort(sorted.begin(), sorted.end(), [](const Total& a, const Total& b) { return a.milliseconds > b.milliseconds; });
+		if(sorted.size() > count)
+			sorted.resize(count);
+
+		return sorted;
+	}
+
+	bool writeTrace(const std::string& path)
+	{
+		std::vector<Event> events;
+		{
+			std::unique_lock<std::mutex> lock(sMutex);
+			if(sWrapped)
+				events.insert(events.cend(), sEvents.cbegin() + sNext, sEvents.cend());
+			events.insert(events.cend(), sEvents.cbegin(), sEvents.cbegin() + sNext);
+		}
+
+		std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+		if(!file.is_open())
+		{
+			LOG(LogError) << "Could not write trace file \"" << path << "\"!";
+			return false;
+		}
+
+		std::map<const char*, std::string> names;
+		file << "{\"traceEvents\":[";
+		for(auto it = events.cbegin(); it != events.cend(); it++)
+		{
+			auto name = names.find(it->name);
+			if(name == names.cend())
+				name = names.insert(std::make_pair(it->name, escapeJson(getReadableName(it->name)))).first;
+
+			file << ((it == events.cbegin()) ? "\n" : ",\n") << "{\"name\":\"" << name->second << "\",\"cat\":\"" << it->category <<
+				"\",\"ph\":\"X\",\"ts\":" << it->start << ",\"dur\":" << it->duration << ",\"pid\":1,\"tid\":" << it->thread << "}";
+		}
+		file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+		file.close();
+
+		if(file.fail())
+		{
+			LOG(LogError) << "Error writing trace file \"" << path << "\"!";
+			return false;
+		}
+
+		LOG(LogInfo) << "Wrote " << events.size() << " profiler events to \"" << path << "\"";
+		return true;
+	}
+
+} // Profiler::
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef ES_CORE_PROFILER_H
+#define ES_CORE_PROFILER_H
+
+#include <string>
+#include <vector>
+
+// Scoped timers around the hot paths (component update and render, texture decodes and uploads, text cache
+// builds). The timings go into a ring buffer which the framerate overlay sums up by name, and which can be
+// written out in Chrome's trace event format to open in chrome://tracing or Perfetto.
+// Nothing is recorded while it's disabled, a timer then only checks a flag.
+namespace Profiler
+{
+	class ScopedTimer
+	{
+	public:
+		// name has to stay valid for as long as the profiler runs, i.e. a literal or a typeid() name
+		ScopedTimer(const char* category, const char* name);
+		~ScopedTimer();
+
+	private:
+		const char* mCategory;
+		const char* mName;
+		long long   mStart;
+	};
+
+	struct Total
+	{
+		std::string  name;
+		std::string  category;
+		double       milliseconds;
+		unsigned int count;
+	};
+
+	void setEnabled(bool enabled);
+	bool isEnabled();
+
+	// what took the most time on the main thread during the last period milliseconds, at most count of them
+	std::vector<Total> getTotals(unsigned int period, size_t count);
+	// writes everything in the ring buffer, returns false if the file couldn't be written
+	bool writeTrace(const std::string& path);
+
+} // Profiler::
+
+#endif // ES_CORE_PROFILER_H
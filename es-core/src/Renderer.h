@@ -2,6 +2,7 @@
 #ifndef ES_CORE_RENDERER_H
 #define ES_CORE_RENDERER_H
 
+#include "math/Vector2f.h"
 #include "math/Vector2i.h"
 #include "platform.h"
 #include GLHEADER
@@ -35,6 +36,27 @@ namespace Renderer
 	void popClipRect();
 
 	void setMatrix(const Transform4x4f& transform);
+	const Transform4x4f& getMatrix();
+
+	// Textured triangles drawn with drawTriangles() are batched with the current matrix applied on the CPU.
+	// Ones sharing a texture and blend mode go in the same draw call, a later one joins an earlier draw only
+	// when it doesn't overlap anything drawn in between so the result looks the same.
+	// posTex holds the position and texture coordinate of each vertex, interleaved.
+	void drawTriangles(GLuint textureId, const Vector2f* posTex, const GLubyte* colors, unsigned int vertCount, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
+	void flushTriangles();
+
+	// Text and triangles are batched and drawn when flushed. Anything drawn directly has to flush first so it
+	// ends up on top of what was submitted before it. Changing the clip rect and swapping buffers flush too.
+	void flush();
+	void endFrame(); // flushes and starts counting a new frame, called by swapBuffers()
+
+	struct BatchStats
+	{
+		unsigned int drawCalls;
+		unsigned int binds;
+		unsigned int vertices;
+	};
+	const BatchStats& getBatchStats(); // of drawTriangles() in the last complete frame
 
 	void drawRect(int x, int y, int w, int h, unsigned int color, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
 	void drawRect(float x, float y, float w, float h, unsigned int color, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
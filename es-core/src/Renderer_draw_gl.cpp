@@ -1,8 +1,12 @@
 #include "Renderer.h"
 
 #include "math/Misc.h"
+#include "math/Transform4x4f.h"
+#include "resources/Font.h"
 #include "Log.h"
+#include <float.h>
 #include <stack>
+#include <vector>
 
 namespace Renderer {
 	struct ClipRect {
@@ -15,6 +19,23 @@ namespace Renderer {
 	};
 
 	std::stack<ClipRect> clipStack;
+	Transform4x4f currentMatrix = Transform4x4f::Identity();
+
+	// one draw call of the triangle batch
+	struct TriangleBatch
+	{
+		GLuint textureId;
+		GLenum sfactor;
+		GLenum dfactor;
+		std::vector<Vector2f> posTex;
+		std::vector<GLubyte> colors;
+		Vector2f boundsMin; // of everything in it, after transforming
+		Vector2f boundsMax;
+	};
+
+	std::vector<TriangleBatch> triangleBatches;
+	BatchStats batchStats = { 0, 0, 0 };
+	BatchStats lastFrameBatchStats = { 0, 0, 0 };
 
 	void setColor4bArray(GLubyte* array, unsigned int color)
 	{
@@ -82,6 +103,7 @@ namespace Renderer {
 
 		clipStack.push(box);
 
+		flush();
 		glScissor(box.x, box.y, box.w, box.h);
 		glEnable(GL_SCISSOR_TEST);
 	}
@@ -95,6 +117,7 @@ namespace Renderer {
 		}
 
 		clipStack.pop();
+		flush();
 		if(clipStack.empty())
 		{
 			glDisable(GL_SCISSOR_TEST);
@@ -128,6 +151,7 @@ namespace Renderer {
 		GLubyte colors[6*4];
 		buildGLColorArray(colors, color, 6);
 
+		flush();
 		glEnable(GL_BLEND);
 		glBlendFunc(blend_sfactor, blend_dfactor);
 		glEnableClientState(GL_VERTEX_ARRAY);
@@ -149,6 +173,136 @@ namespace Renderer {
 
 	void setMatrix(const Transform4x4f& matrix)
 	{
+		currentMatrix = matrix;
 		glLoadMatrixf((GLfloat*)&matrix);
 	}
+
+	const Transform4x4f& getMatrix()
+	{
+		return currentMatrix;
+	}
+
+	void drawTriangles(GLuint textureId, const Vector2f* posTex, const GLubyte* colors, unsigned int vertCount, GLenum blend_sfactor, GLenum blend_dfactor)
+	{
+		if((vertCount == 0) || (textureId == 0))
+			return;
+
+		// text submitted before has to stay underneath
+		Font::flushTextBatch();
+
+		std::vector<Vector2f> transformed(vertCount * 2);
+		Vector2f boundsMin(FLT_MAX, FLT_MAX);
+		Vector2f boundsMax(-FLT_MAX, -FLT_MAX);
+		for(unsigned int i = 0; i < vertCount; i++)
+		{
+			const Vector3f pos = currentMatrix * Vector3f(posTex[i * 2].x(), posTex[i * 2].y(), 0.0f);
+			transformed[i * 2] = Vector2f(pos.x(), pos.y());
+			transformed[i * 2 + 1] = posTex[i * 2 + 1];
+
+			boundsMin = Vector2f(Math::min(boundsMin.x(), pos.x()), Math::min(boundsMin.y(), pos.y()));
+			boundsMax = Vector2f(Math::max(boundsMax.x(), pos.x()), Math::max(boundsMax.y(), pos.y()));
+		}
+
+		// look for an earlier draw with the same state, as long as nothing in between is underneath these triangles
+		TriangleBatch* batch = nullptr;
+		for(auto it = triangleBatches.rbegin(); it != triangleBatches.rend(); it++)
+		{
+			if((it->textureId == textureId) && (it->sfactor == blend_sfactor) && (it->dfactor == blend_dfactor))
+			{
+				batch = &(*it);
+				break;
+			}
+
+			if((it->boundsMin.x() < boundsMax.x()) && (boundsMin.x() < it->boundsMax.x()) &&
+			   (it->boundsMin.y() < boundsMax.y()) && (boundsMin.y() < it->boundsMax.y()))
+				break;
+		}
+
+		if(batch == nullptr)
+		{
+			triangleBatches.push_back(TriangleBatch());
+			batch = &triangleBatches.back();
+			batch->textureId = textureId;
+			batch->sfactor = blend_sfactor;
+			batch->dfactor = blend_dfactor;
+			batch->boundsMin = boundsMin;
+			batch->boundsMax = boundsMax;
+		}
+		else
+		{
+			batch->boundsMin = Vector2f(Math::min(batch->boundsMin.x(), boundsMin.x()), Math::min(batch->boundsMin.y(), boundsMin.y()));
+			batch->boundsMax = Vector2f(Math::max(batch->boundsMax.x(), boundsMax.x()), Math::max(batch->boundsMax.y(), boundsMax.y()));
+		}
+
+		batch->posTex.insert(batch->posTex.cend(), transformed.cbegin(), transformed.cend());
+		batch->colors.insert(batch->colors.cend(), colors, colors + vertCount * 4);
+	}
+
+	void flushTriangles()
+	{
+		if(triangleBatches.empty())
+			return;
+
+		// the vertices are transformed already
+		glLoadIdentity();
+
+		glEnable(GL_TEXTURE_2D);
+		glEnable(GL_BLEND);
+
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+
+		GLuint boundTexture = 0;
+		for(auto it = triangleBatches.cbegin(); it != triangleBatches.cend(); it++)
+		{
+			if((it == triangleBatches.cbegin()) || (it->textureId != boundTexture))
+			{
+				glBindTexture(GL_TEXTURE_2D, it->textureId);
+				boundTexture = it->textureId;
+				batchStats.binds++;
+			}
+
+			glBlendFunc(it->sfactor, it->dfactor);
+
+			glVertexPointer(2, GL_FLOAT, sizeof(Vector2f) * 2, &it->posTex[0]);
+			glTexCoordPointer(2, GL_FLOAT, sizeof(Vector2f) * 2, &it->posTex[1]);
+			glColorPointer(4, GL_UNSIGNED_BYTE, 0, it->colors.data());
+
+			glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(it->posTex.size() / 2));
+			batchStats.drawCalls++;
+			batchStats.vertices += (unsigned int)(it->posTex.size() / 2);
+		}
+
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_COLOR_ARRAY);
+
+		glDisable(GL_TEXTURE_2D);
+		glDisable(GL_BLEND);
+
+		triangleBatches.clear();
+		glLoadMatrixf((GLfloat*)&currentMatrix);
+	}
+
+	void flush()
+	{
+		// only one of them has anything in it, each flushes the other before adding to itself
+		Font::flushTextBatch();
+		flushTriangles();
+	}
+
+	void endFrame()
+	{
+		flush();
+		Font::endTextBatchFrame();
+
+		lastFrameBatchStats = batchStats;
+		batchStats = { 0, 0, 0 };
+	}
+
+	const BatchStats& getBatchStats()
+	{
+		return lastFrameBatchStats;
+	}
 };
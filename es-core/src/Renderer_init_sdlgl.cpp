@@ -37,6 +37,11 @@ namespace Renderer
 	{
 		LOG(LogInfo) << "Creating surface...";
 
+		// headless renders through SDL's offscreen driver into an EGL pbuffer, so it doesn't need a display
+		const bool headless = Settings::getInstance()->getBool("Headless");
+		if(headless)
+			SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+
 		if(SDL_Init(SDL_INIT_VIDEO) != 0)
 		{
 			LOG(LogError) << "Error initializing SDL!\n	" << SDL_GetError();
@@ -61,7 +66,11 @@ namespace Renderer
 #endif
 
 		SDL_DisplayMode dispMode;
-		SDL_GetDesktopDisplayMode(0, &dispMode);
+		if(SDL_GetDesktopDisplayMode(0, &dispMode) != 0 || !dispMode.w || !dispMode.h)
+		{
+			dispMode.w = 1280;
+			dispMode.h = 720;
+		}
 		windowWidth   = Settings::getInstance()->getInt("WindowWidth")   ? Settings::getInstance()->getInt("WindowWidth")   : dispMode.w;
 		windowHeight  = Settings::getInstance()->getInt("WindowHeight")  ? Settings::getInstance()->getInt("WindowHeight")  : dispMode.h;
 		screenWidth   = Settings::getInstance()->getInt("ScreenWidth")   ? Settings::getInstance()->getInt("ScreenWidth")   : windowWidth;
@@ -73,7 +82,7 @@ namespace Renderer
 		sdlWindow = SDL_CreateWindow("EmulationStation", 
 			SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 
 			windowWidth, windowHeight, 
-			SDL_WINDOW_OPENGL | (Settings::getInstance()->getBool("Windowed") ? 0 : SDL_WINDOW_FULLSCREEN));
+			SDL_WINDOW_OPENGL | (headless ? SDL_WINDOW_HIDDEN : (Settings::getInstance()->getBool("Windowed") ? 0 : SDL_WINDOW_FULLSCREEN)));
 
 		if(sdlWindow == NULL)
 		{
@@ -124,8 +133,14 @@ namespace Renderer
 
 		sdlContext = SDL_GL_CreateContext(sdlWindow);
 
-		// vsync
-		if(Settings::getInstance()->getBool("VSync"))
+		if(sdlContext == NULL)
+		{
+			LOG(LogError) << "Error creating OpenGL context!\n\t" << SDL_GetError();
+			return false;
+		}
+
+		// vsync, never when headless since it would only hold benchmarks back
+		if(Settings::getInstance()->getBool("VSync") && !headless)
 		{
 			// SDL_GL_SetSwapInterval(0) for immediate updates (no vsync, default), 
 			// 1 for updates synchronized with the vertical retrace, 
@@ -216,6 +231,8 @@ namespace Renderer
 
 	void swapBuffers()
 	{
+		endFrame();
+
 		SDL_GL_SwapWindow(sdlWindow);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	}
@@ -19,6 +19,7 @@ std::vector<const char*> settings_dont_save {
 	{ "ForceKid" },
 	{ "ForceKiosk" },
 	{ "IgnoreGamelist" },
+	{ "RebuildLibraryCache" },
 	{ "HideConsole" },
 	{ "ShowExit" },
 	{ "SplashScreen" },
@@ -31,7 +32,12 @@ std::vector<const char*> settings_dont_save {
 	{ "ScreenOffsetX" },
 	{ "ScreenOffsetY" },
 	{ "ScreenRotate" },
-	{ "ExePath" }
+	{ "ExePath" },
+	{ "Headless" },
+	{ "BenchmarkFrames" },
+	{ "BenchmarkFrameTime" },
+	{ "BenchmarkInputScript" },
+	{ "TraceFile" }
 };
 
 Settings::Settings()
@@ -55,6 +61,11 @@ void Settings::setDefaults()
 
 	mBoolMap["BackgroundJoystickInput"] = false;
 	mBoolMap["ParseGamelistOnly"] = false;
+	mBoolMap["ParallelSystemLoading"] = true;
+	mBoolMap["LibraryCache"] = true;
+	mBoolMap["RebuildLibraryCache"] = false;
+	mBoolMap["ThumbnailCache"] = true;
+	mIntMap["ThumbnailCacheSize"] = 256; // MB on disk, the least recently used thumbnails are deleted past it. 0 means no limit
 	mBoolMap["ShowHiddenFiles"] = false;
 	mBoolMap["DrawFramerate"] = false;
 	mBoolMap["ShowExit"] = true;
@@ -83,10 +94,14 @@ void Settings::setDefaults()
 	mIntMap["ScraperResizeHeight"] = 0;
 	#ifdef _RPI_
 		mIntMap["MaxVRAM"] = 80;
+		mIntMap["MaxTextureRAM"] = 80;
 	#else
 		mIntMap["MaxVRAM"] = 100;
+		mIntMap["MaxTextureRAM"] = 200;
 	#endif
-
+	mIntMap["TextureLoaderThreads"] = 0; // 0 uses all but one of the cores
+	mIntMap["ImagePrefetchCount"] = 3; // games around the cursor to load images for ahead of time, 0 disables it
+	mIntMap["VideoPlayerPoolSize"] = 2; // stopped video players kept to play the next video of the same size, 0 disables it
 	mStringMap["TransitionStyle"] = "fade";
 	mStringMap["ThemeSet"] = "";
 	mStringMap["ScreenSaverBehavior"] = "dim";
@@ -149,6 +164,13 @@ void Settings::setDefaults()
 	mIntMap["ScreenRotate"]  = 0;
 
 	mStringMap["ExePath"] = "";
+
+	// benchmarking, see FrameDriver
+	mBoolMap["Headless"] = false; // render offscreen, no display needed
+	mIntMap["BenchmarkFrames"] = 0; // 0 runs normally
+	mIntMap["BenchmarkFrameTime"] = 16;
+	mStringMap["BenchmarkInputScript"] = "";
+	mStringMap["TraceFile"] = ""; // profiler trace written on exit, see Profiler
 }
 
 template <typename K, typename V>
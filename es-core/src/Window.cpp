@@ -2,16 +2,32 @@
 
 #include "components/HelpComponent.h"
 #include "components/ImageComponent.h"
+#include "components/VideoVlcComponent.h"
 #include "resources/Font.h"
+#include "resources/TextureData.h"
 #include "resources/TextureResource.h"
+#include "utils/FileSystemUtil.h"
 #include "InputManager.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include <algorithm>
 #include <iomanip>
+#include <typeinfo>
+
+// frames are rendered at least this often (in ms) even if nothing reported a change
+#define MAX_IDLE_FRAME_TIME 1000
+
+// --trace-file, or es_trace.json in the config directory
+static std::string getTraceFilePath()
+{
+	const std::string path = Settings::getInstance()->getString("TraceFile");
+	return path.empty() ? (Utils::FileSystem::getHomePath() + "/.emulationstation/es_trace.json") : path;
+}
 
 Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mAverageDeltaTime(10),
-	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mInfoPopup(NULL)
+	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mInfoPopup(NULL),
+	mInvalidated(true), mTimeSinceLastRender(0)
 {
 	mHelp = new HelpComponent(this);
 	mBackgroundOverlay = new ImageComponent(this);
@@ -37,6 +53,7 @@ void Window::pushGui(GuiComponent* gui)
 	}
 	mGuiStack.push_back(gui);
 	gui->updateHelpPrompts();
+	invalidate();
 }
 
 void Window::removeGui(GuiComponent* gui)
@@ -46,6 +63,7 @@ void Window::removeGui(GuiComponent* gui)
 		if(*i == gui)
 		{
 			i = mGuiStack.erase(i);
+			invalidate();
 
 			if(i == mGuiStack.cend() && mGuiStack.size()) // we just popped the stack and the stack is not empty
 			{
@@ -93,6 +111,8 @@ bool Window::init()
 	if(peekGui())
 		peekGui()->updateHelpPrompts();
 
+	invalidate();
+
 	return true;
 }
 
@@ -103,6 +123,8 @@ void Window::deinit()
 	{
 		(*i)->onHide();
 	}
+	// The videos were stopped by hiding them, so every player is idle now
+	VideoVlcComponent::releasePlayerPool();
 	InputManager::getInstance()->deinit();
 	ResourceManager::getInstance()->unloadAll();
 	Renderer::deinit();
@@ -110,12 +132,17 @@ void Window::deinit()
 
 void Window::textInput(const char* text)
 {
+	invalidate();
+
 	if(peekGui())
 		peekGui()->textInput(text);
 }
 
 void Window::input(InputConfig* config, Input input)
 {
+	// whatever the input does, it's likely to show
+	invalidate();
+
 	if (mScreenSaver) {
 		if(mScreenSaver->isScreenSaverActive() && Settings::getInstance()->getBool("ScreenSaverControls") &&
 		   (Settings::getInstance()->getString("ScreenSaverBehavior") == "random video"))
@@ -174,6 +201,11 @@ void Window::input(InputConfig* config, Input input)
 		// toggle TextComponent debug view with Ctrl-I
 		Settings::getInstance()->setBool("DebugImage", !Settings::getInstance()->getBool("DebugImage"));
 	}
+	else if(config->getDeviceId() == DEVICE_KEYBOARD && input.value && input.id == SDLK_p && SDL_GetModState() & KMOD_LCTRL && Settings::getInstance()->getBool("Debug"))
+	{
+		// dump the profiler's ring buffer as a Chrome trace with Ctrl-P
+		Profiler::writeTrace(getTraceFilePath());
+	}
 	else
 	{
 		if (peekGui())
@@ -198,6 +230,10 @@ void Window::update(int deltaTime)
 	{
 		mAverageDeltaTime = mFrameTimeElapsed / mFrameCountElapsed;
 
+		// only profile when something is going to look at it
+		Profiler::setEnabled(Settings::getInstance()->getBool("DrawFramerate") || Settings::getInstance()->getBool("Debug") ||
+			!Settings::getInstance()->getString("TraceFile").empty());
+
 		if(Settings::getInstance()->getBool("DrawFramerate"))
 		{
 			std::stringstream ss;
@@ -213,6 +249,44 @@ void Window::update(int deltaTime)
 
 			ss << "\nFont VRAM: " << fontVramUsageMb << " Tex VRAM: " << textureVramUsageMb <<
 				  " Tex Max: " << textureTotalUsageMb;
+
+			// where the texture memory is right now: uploaded, decoded in RAM, or waiting to be loaded
+			ss << "\nUploaded: " << TextureData::getTotalVRAMUsage() / 1000.0f / 1000.0f <<
+				  " Decoded: " << TextureData::getTotalRAMUsage() / 1000.0f / 1000.0f <<
+				  " Queued: " << TextureResource::getQueuedMemUsage() / 1000.0f / 1000.0f;
+
+			// triangle batching of images and nine patches
+			const Renderer::BatchStats& batchStats = Renderer::getBatchStats();
+			ss << "\nBatches: " << batchStats.drawCalls << " draw calls " << batchStats.binds << " binds " <<
+				  batchStats.vertices << " vertices";
+
+			// text batching, the draw calls should follow the number of font textures rather than the number of strings
+			const Font::TextBatchStats& textStats = Font::getTextBatchStats();
+			ss << "\nText: " << textStats.caches << " strings in " << textStats.drawCalls << " draw calls";
+
+			// texture cache tiers, RAM hits are textures that came back to VRAM without being decoded again
+			const TextureDataManager::TierStats& vramStats = TextureResource::getVRAMStats();
+			const TextureDataManager::TierStats& ramStats = TextureResource::getRAMStats();
+			ss << "\nVRAM hits: " << vramStats.hits << " misses: " << vramStats.misses <<
+				  " RAM hits: " << ramStats.hits << " misses: " << ramStats.misses;
+
+			// image prefetch, a low hit rate with a lot of late ones means MaxTextureRAM is too small for ImagePrefetchCount
+			const TextureResource::PrefetchStats& prefetch = TextureResource::getPrefetchStats();
+			const unsigned int prefetchDone = prefetch.hits + prefetch.late + prefetch.unused;
+			ss << "\nPrefetch: " << prefetch.requested << " Hits: " << prefetch.hits << " Late: " << prefetch.late <<
+				  " Unused: " << prefetch.unused << " Hit rate: " << std::setprecision(1) <<
+				  (prefetchDone ? (100.0f * prefetch.hits / prefetchDone) : 0.0f) << "%";
+
+			// video players, browsing between videos of the same size should mostly reuse them
+			const VideoVlcComponent::PlayerPoolStats& players = VideoVlcComponent::getPlayerPoolStats();
+			ss << "\nVideo players: " << players.created << " Reused: " << players.reused << " Released: " << players.released;
+			// where the time went, inclusive of children so a view includes all of its elements
+			const std::vector<Profiler::Total> totals = Profiler::getTotals(mFrameTimeElapsed, 6);
+			if(!totals.empty())
+				ss << "\nms/frame:";
+			for(auto it = totals.cbegin(); it != totals.cend(); it++)
+				ss << "\n  " << std::setprecision(2) << (it->milliseconds / mFrameCountElapsed) << " " << it->category << " " << it->name;
+
 			mFrameDataText = std::unique_ptr<TextCache>(mDefaultFonts.at(1)->buildTextCache(ss.str(), 50.f, 50.f, 0xFF00FFFF));
 		}
 
@@ -222,9 +296,33 @@ void Window::update(int deltaTime)
 
 	mTimeSinceLastInput += deltaTime;
 
+	// the overlay is there to measure rendering, so don't skip any; otherwise redraw once in a while
+	// in case something changed without invalidating
+	mTimeSinceLastRender += deltaTime;
+	if(Settings::getInstance()->getBool("DrawFramerate") || mTimeSinceLastRender >= MAX_IDLE_FRAME_TIME)
+		invalidate();
+
 	if(peekGui())
-		peekGui()->update(deltaTime);
-	
+	{
+		GuiComponent* gui = peekGui();
+		Profiler::ScopedTimer timer("update", typeid(*gui).name());
+		gui->update(deltaTime);
+	}
+
+	// checked here rather than in render() since frames without changes are skipped
+	unsigned int screensaverTime = (unsigned int)Settings::getInstance()->getInt("ScreenSaverTime");
+	if(mTimeSinceLastInput >= screensaverTime && screensaverTime != 0)
+	{
+		startScreenSaver();
+
+		if (!isProcessing() && mAllowSleep && (!mScreenSaver || mScreenSaver->allowSleep()))
+		{
+			// go to sleep
+			mSleeping = true;
+			onSleep();
+		}
+	}
+
 	// Update the screensaver
 	if (mScreenSaver)
 		mScreenSaver->update(deltaTime);
@@ -234,6 +332,10 @@ void Window::render()
 {
 	Transform4x4f transform = Transform4x4f::Identity();
 
+	// anything invalidating while rendering, like an image that's still loading, asks for the next frame
+	mInvalidated = false;
+	mTimeSinceLastRender = 0;
+
 	mRenderedHelpPrompts = false;
 
 	// draw only bottom and top of GuiStack (if they are different)
@@ -242,10 +344,15 @@ void Window::render()
 		auto& bottom = mGuiStack.front();
 		auto& top = mGuiStack.back();
 
-		bottom->render(transform);
+		{
+			Profiler::ScopedTimer timer("render", typeid(*bottom).name());
+			bottom->render(transform);
+		}
 		if(bottom != top)
 		{
 			mBackgroundOverlay->render(transform);
+
+			Profiler::ScopedTimer timer("render", typeid(*top).name());
 			top->render(transform);
 		}
 	}
@@ -259,10 +366,6 @@ void Window::render()
 		mDefaultFonts.at(1)->renderTextCache(mFrameDataText.get());
 	}
 
-	unsigned int screensaverTime = (unsigned int)Settings::getInstance()->getInt("ScreenSaverTime");
-	if(mTimeSinceLastInput >= screensaverTime && screensaverTime != 0)
-		startScreenSaver();
-	
 	// Always call the screensaver render function regardless of whether the screensaver is active
 	// or not because it may perform a fade on transition
 	renderScreenSaver();
@@ -271,16 +374,6 @@ void Window::render()
 	{
 		mInfoPopup->render(transform);
 	}
-	
-	if(mTimeSinceLastInput >= screensaverTime && screensaverTime != 0)
-	{
-		if (!isProcessing() && mAllowSleep && (!mScreenSaver || mScreenSaver->allowSleep()))
-		{
-			// go to sleep
-			mSleeping = true;
-			onSleep();
-		}
-	}
 }
 
 void Window::normalizeNextUpdate()
@@ -298,7 +391,7 @@ void Window::setAllowSleep(bool sleep)
 	mAllowSleep = sleep;
 }
 
-void Window::renderLoadingScreen()
+void Window::renderLoadingScreen(const std::string& text)
 {
 	Transform4x4f trans = Transform4x4f::Identity();
 	Renderer::setMatrix(trans);
@@ -311,7 +404,7 @@ void Window::renderLoadingScreen()
 	splash.render(trans);
 
 	auto& font = mDefaultFonts.at(1);
-	TextCache* cache = font->buildTextCache("LOADING...", 0, 0, 0x656565FF);
+	TextCache* cache = font->buildTextCache(text, 0, 0, 0x656565FF);
 	trans = trans.translate(Vector3f(Math::round((Renderer::getScreenWidth() - cache->metrics.size.x()) / 2.0f),
 		Math::round(Renderer::getScreenHeight() * 0.835f), 0.0f));
 	Renderer::setMatrix(trans);
@@ -394,6 +487,7 @@ void Window::setHelpPrompts(const std::vector<HelpPrompt>& prompts, const HelpSt
 	});
 
 	mHelp->setPrompts(addPrompts);
+	invalidate();
 }
 
 
@@ -421,6 +515,7 @@ void Window::startScreenSaver()
 
  		mScreenSaver->startScreenSaver();
  		mRenderScreenSaver = true;
+ 		invalidate();
  	}
  }
 
@@ -430,6 +525,7 @@ void Window::startScreenSaver()
  	{
  		mScreenSaver->stopScreenSaver();
  		mRenderScreenSaver = false;
+ 		invalidate();
 
  		// Tell the GUI components the screensaver has stopped
  		for(auto i = mGuiStack.cbegin(); i != mGuiStack.cend(); i++)
@@ -59,17 +59,22 @@ public:
 
 	void normalizeNextUpdate();
 
+	// Something on screen changed (input, an animation, a video frame, ...) and the next frame has to be rendered.
+	// The main loop skips rendering while nothing is invalidated and waits for events instead.
+	inline void invalidate() { mInvalidated = true; }
+	inline bool isInvalidated() const { return mInvalidated; }
+
 	inline bool isSleeping() const { return mSleeping; }
 	bool getAllowSleep();
 	void setAllowSleep(bool sleep);
 
-	void renderLoadingScreen();
+	void renderLoadingScreen(const std::string& text = "LOADING...");
 
 	void renderHelpPromptsEarly(); // used to render HelpPrompts before a fade
 	void setHelpPrompts(const std::vector<HelpPrompt>& prompts, const HelpStyle& style);
 
 	void setScreenSaver(ScreenSaver* screenSaver) { mScreenSaver = screenSaver; }
-	void setInfoPopup(InfoPopup* infoPopup) { delete mInfoPopup; mInfoPopup = infoPopup; }
+	void setInfoPopup(InfoPopup* infoPopup) { delete mInfoPopup; mInfoPopup = infoPopup; invalidate(); }
 	inline void stopInfoPopup() { if (mInfoPopup) mInfoPopup->stop(); };
 
 	void startScreenSaver();
@@ -106,6 +111,9 @@ private:
 	unsigned int mTimeSinceLastInput;
 
 	bool mRenderedHelpPrompts;
+
+	bool mInvalidated;
+	unsigned int mTimeSinceLastRender;
 };
 
 #endif // ES_CORE_WINDOW_H
@@ -3,6 +3,7 @@
 #include "components/ImageComponent.h"
 #include "resources/ResourceManager.h"
 #include "Log.h"
+#include "Window.h"
 
 AnimatedImageComponent::AnimatedImageComponent(Window* window) : GuiComponent(window), mEnabled(false)
 {
@@ -55,6 +56,7 @@ void AnimatedImageComponent::update(int deltaTime)
 	if(!mEnabled || mFrames.size() == 0)
 		return;
 
+	const int lastFrame = mCurrentFrame;
 	mFrameAccumulator += deltaTime;
 
 	while(mFrames.at(mCurrentFrame).second <= mFrameAccumulator)
@@ -77,6 +79,9 @@ void AnimatedImageComponent::update(int deltaTime)
 
 		mFrameAccumulator -= mFrames.at(mCurrentFrame).second;
 	}
+
+	if(mCurrentFrame != lastFrame)
+		mWindow->invalidate();
 }
 
 void AnimatedImageComponent::render(const Transform4x4f& trans)
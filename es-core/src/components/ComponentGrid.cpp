@@ -365,6 +365,7 @@ void ComponentGrid::render(const Transform4x4f& parentTrans)
 	if(mLines.size())
 	{
 		Renderer::setMatrix(trans);
+		Renderer::flush();
 
 		glEnable(GL_BLEND);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
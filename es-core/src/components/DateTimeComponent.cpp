@@ -3,6 +3,7 @@
 #include "resources/Font.h"
 #include "utils/StringUtil.h"
 #include "Renderer.h"
+#include "Window.h"
 
 DateTimeComponent::DateTimeComponent(Window* window, DisplayMode dispMode) : GuiComponent(window), 
 	mEditing(false), mEditIndex(0), mDisplayMode(dispMode), mRelativeUpdateAccumulator(0), 
@@ -132,6 +133,7 @@ void DateTimeComponent::update(int deltaTime)
 		{
 			mRelativeUpdateAccumulator = 0;
 			updateTextCache();
+			mWindow->invalidate();
 		}
 	}
 
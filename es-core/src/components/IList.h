@@ -5,6 +5,7 @@
 #include "components/ImageComponent.h"
 #include "resources/Font.h"
 #include "PowerSaver.h"
+#include "Window.h"
 
 enum CursorState
 {
@@ -103,6 +104,29 @@ public:
 		return mScrollVelocity;
 	}
 
+	// Returns the entries that are likely to be selected next, nearest first. While scrolling it looks
+	// further ahead the faster the list goes, otherwise it returns count entries to either side.
+	std::vector<UserData> getUpcoming(int count) const
+	{
+		std::vector<UserData> upcoming;
+		if(count <= 0 || size() < 2)
+			return upcoming;
+
+		const int ahead = (mScrollVelocity == 0) ? count : count * (mScrollTier + 1);
+		const int behind = (mScrollVelocity == 0) ? count : 0;
+		const int step = (mScrollVelocity == 0) ? 1 : mScrollVelocity;
+
+		for(int i = 1; (i <= ahead || i <= behind) && (int)upcoming.size() < size() - 1; i++)
+		{
+			if(i <= ahead)
+				upcoming.push_back(mEntries.at(wrapCursor(mCursor + (i * step))).object);
+			if(i <= behind)
+				upcoming.push_back(mEntries.at(wrapCursor(mCursor - (i * step))).object);
+		}
+
+		return upcoming;
+	}
+
 	void stopScrolling()
 	{
 		listInput(0);
@@ -208,6 +232,7 @@ protected:
 	void listUpdate(int deltaTime)
 	{
 		// update the title overlay opacity
+		const unsigned char lastOpacity = mTitleOverlayOpacity;
 		const int dir = (mScrollTier >= mTierList.count - 1) ? 1 : -1; // fade in if scroll tier is >= 1, otherwise fade out
 		int op = mTitleOverlayOpacity + deltaTime*dir; // we just do a 1-to-1 time -> opacity, no scaling
 		if(op >= 255)
@@ -217,6 +242,9 @@ protected:
 		else
 			mTitleOverlayOpacity = (unsigned char)op;
 
+		if(mTitleOverlayOpacity != lastOpacity)
+			mWindow->invalidate();
+
 		if(mScrollVelocity == 0 || size() < 2)
 			return;
 
@@ -242,6 +270,9 @@ protected:
 		// actually perform the scrolling
 		for(int i = 0; i < scrollCount; i++)
 			scroll(mScrollVelocity);
+
+		if(scrollCount > 0)
+			mWindow->invalidate();
 	}
 
 	void listRenderTitleOverlay(const Transform4x4f& /*trans*/)
@@ -305,6 +336,8 @@ protected:
 		onCursorChanged((mScrollTier > 0) ? CURSOR_SCROLLING : CURSOR_STOPPED);
 	}
 
+	inline int wrapCursor(int cursor) const { return ((cursor % size()) + size()) % size(); }
+
 	virtual void onCursorChanged(const CursorState& /*state*/) {}
 	virtual void onScroll(int /*amt*/) {}
 };
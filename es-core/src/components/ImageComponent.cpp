@@ -5,6 +5,7 @@
 #include "Renderer.h"
 #include "Settings.h"
 #include "ThemeData.h"
+#include "Window.h"
 
 Vector2i ImageComponent::getTextureSize() const
 {
@@ -102,19 +103,25 @@ void ImageComponent::setImage(std::string path, bool tile)
 	if(path.empty() || !ResourceManager::getInstance()->fileExists(path))
 	{
 		if(mDefaultPath.empty() || !ResourceManager::getInstance()->fileExists(mDefaultPath))
-			mTexture.reset();
+			mTexturePath.clear();
 		else
-			mTexture = TextureResource::get(mDefaultPath, tile, mForceLoad, mDynamic);
+			mTexturePath = mDefaultPath;
 	} else {
-		mTexture = TextureResource::get(path, tile, mForceLoad, mDynamic);
+		mTexturePath = path;
 	}
 
+	if(mTexturePath.empty())
+		mTexture.reset();
+	else
+		mTexture = TextureResource::get(mTexturePath, tile, mForceLoad, mDynamic, getTextureDisplaySize());
+
 	resize();
 }
 
 void ImageComponent::setImage(const char* path, size_t length, bool tile)
 {
 	mTexture.reset();
+	mTexturePath.clear();
 
 	mTexture = TextureResource::get("", tile);
 	mTexture->initFromMemory(path, length);
@@ -125,13 +132,43 @@ void ImageComponent::setImage(const char* path, size_t length, bool tile)
 void ImageComponent::setImage(const std::shared_ptr<TextureResource>& texture)
 {
 	mTexture = texture;
+	mTexturePath.clear();
 	resize();
 }
 
+std::shared_ptr<TextureResource> ImageComponent::prefetchImage(const std::string& path, TextureLoadPriority priority)
+{
+	if(path.empty() || !ResourceManager::getInstance()->fileExists(path))
+		return nullptr;
+
+	return TextureResource::prefetch(path, false, getTextureDisplaySize(), priority);
+}
+
+Vector2i ImageComponent::getTextureDisplaySize() const
+{
+	return Vector2i((int)Math::round(mTargetSize.x()), (int)Math::round(mTargetSize.y()));
+}
+
+void ImageComponent::updateScaledTexture()
+{
+	if(!mTexture || mTexturePath.empty() || mTexture->isTiled())
+		return;
+
+	// only a texture that's smaller than its image and now has to cover a larger size needs loading again
+	const Vector2i textureSize = mTexture->getSize();
+	const Vector2f sourceSize = mTexture->getSourceImageSize();
+	if((textureSize.x() >= sourceSize.x() && textureSize.y() >= sourceSize.y()) ||
+		(mTargetSize.x() <= textureSize.x() + 1 && mTargetSize.y() <= textureSize.y() + 1))
+		return;
+
+	mTexture = TextureResource::get(mTexturePath, false, mForceLoad, mDynamic, getTextureDisplaySize());
+}
+
 void ImageComponent::setResize(float width, float height)
 {
 	mTargetSize = Vector2f(width, height);
 	mTargetIsMax = false;
+	updateScaledTexture();
 	resize();
 }
 
@@ -139,6 +176,7 @@ void ImageComponent::setMaxSize(float width, float height)
 {
 	mTargetSize = Vector2f(width, height);
 	mTargetIsMax = true;
+	updateScaledTexture();
 	resize();
 }
 
@@ -251,28 +289,14 @@ void ImageComponent::render(const Transform4x4f& parentTrans)
 			// The bind() function returns false if the texture is not currently loaded. A blank
 			// texture is bound in this case but we want to handle a fade so it doesn't just 'jump' in
 			// when it finally loads
-			fadeIn(mTexture->bind());
-
-			glEnable(GL_TEXTURE_2D);
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-			glEnableClientState(GL_COLOR_ARRAY);
-
-			glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-			glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-			glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-
-			glDrawArrays(GL_TRIANGLES, 0, 6);
+			GLuint textureId = 0;
+			fadeIn(mTexture->bind(&textureId));
 
-			glDisableClientState(GL_VERTEX_ARRAY);
-			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-			glDisableClientState(GL_COLOR_ARRAY);
+			// keep the frames coming until it's loaded and faded in
+			if(mFading)
+				mWindow->invalidate();
 
-			glDisable(GL_TEXTURE_2D);
-			glDisable(GL_BLEND);
+			Renderer::drawTriangles(textureId, &mVertices[0].pos, mColors, 6);
 		}else{
 			LOG(LogError) << "Image texture is not initialized!";
 			mTexture.reset();
@@ -3,6 +3,7 @@
 #define ES_CORE_COMPONENTS_IMAGE_COMPONENT_H
 
 #include "math/Vector2i.h"
+#include "resources/TextureDataManager.h"
 #include "GuiComponent.h"
 #include "platform.h"
 #include GLHEADER
@@ -23,6 +24,8 @@ public:
 	void setImage(const char* image, size_t length, bool tile = false);
 	//Use an already existing texture.
 	void setImage(const std::shared_ptr<TextureResource>& texture);
+	//Starts loading the image at the given filepath in the background, at the size setImage() would use. Keep the texture to keep it loaded.
+	std::shared_ptr<TextureResource> prefetchImage(const std::string& path, TextureLoadPriority priority = TEXTURE_LOAD_PREFETCH);
 
 	void onSizeChanged() override;
 	void setOpacity(unsigned char opacity) override;
@@ -51,6 +54,7 @@ public:
 	void setRotateByTargetSize(bool rotate);  // Flag indicating if rotation should be based on target size vs. actual size.
 
 	// Returns the size of the current texture, or (0, 0) if none is loaded.  May be different than drawn size (use getSize() for that).
+	// Large images are scaled down to the size they're drawn at, so this may also be smaller than the image file.
 	Vector2i getTextureSize() const;
 
 	bool hasImage();
@@ -69,6 +73,11 @@ private:
 	// Used internally whenever the resizing parameters or texture change.
 	void resize();
 
+	// The size textures are loaded for, large images are scaled down to it.
+	Vector2i getTextureDisplaySize() const;
+	// Loads the texture again if it was scaled down for a smaller size than the one it's resized to now.
+	void updateScaledTexture();
+
 	struct Vertex
 	{
 		Vector2f pos;
@@ -84,6 +93,7 @@ private:
 	unsigned int mColorShift;
 
 	std::string mDefaultPath;
+	std::string mTexturePath; // the file mTexture was loaded from by setImage(path)
 
 	std::shared_ptr<TextureResource> mTexture;
 	unsigned char			 mFadeOpacity;
@@ -1,6 +1,7 @@
 #include "components/ScrollableContainer.h"
 
 #include "Renderer.h"
+#include "Window.h"
 
 #define AUTO_SCROLL_RESET_DELAY 3000 // ms to reset to top after we reach the bottom
 #define AUTO_SCROLL_DELAY 1000 // ms to wait before we start to scroll
@@ -58,6 +59,8 @@ void ScrollableContainer::setScrollPos(const Vector2f& pos)
 
 void ScrollableContainer::update(int deltaTime)
 {
+	const Vector2f lastScrollPos = mScrollPos;
+
 	if(mAutoScrollSpeed != 0)
 	{
 		mAutoScrollAccumulator += deltaTime;
@@ -100,6 +103,9 @@ void ScrollableContainer::update(int deltaTime)
 			reset();
 	}
 
+	if(mScrollPos != lastScrollPos)
+		mWindow->invalidate();
+
 	GuiComponent::update(deltaTime);
 }
 
@@ -2,6 +2,7 @@
 
 #include "resources/Font.h"
 #include "Renderer.h"
+#include "Window.h"
 
 #define MOVE_REPEAT_DELAY 500
 #define MOVE_REPEAT_RATE 40
@@ -53,6 +54,7 @@ void SliderComponent::update(int deltaTime)
 		{
 			setValue(mValue + mMoveRate);
 			mMoveAccumulator -= MOVE_REPEAT_RATE;
+			mWindow->invalidate();
 		}
 	}
 	
@@ -3,6 +3,7 @@
 #include "resources/Font.h"
 #include "utils/StringUtil.h"
 #include "Renderer.h"
+#include "Window.h"
 
 #define TEXT_PADDING_HORIZ 10
 #define TEXT_PADDING_VERT 2
@@ -186,6 +187,7 @@ void TextEditComponent::updateCursorRepeat(int deltaTime)
 	{
 		moveCursor(mCursorRepeatDir);
 		mCursorRepeatTimer -= CURSOR_REPEAT_SPEED;
+		mWindow->invalidate();
 	}
 }
 
@@ -10,6 +10,8 @@
 
 #define FADE_TIME_MS	200
 
+bool VideoComponent::sPlaybackDisabled = false;
+
 std::string getTitlePath() {
 	std::string titleFolder = getTitleFolder();
 	return titleFolder + "last_title.srt";
@@ -149,12 +151,6 @@ void VideoComponent::render(const Transform4x4f& parentTrans)
 	GuiComponent::renderChildren(trans);
 
 	Renderer::setMatrix(trans);
-
-	// Handle the case where the video is delayed
-	handleStartDelay();
-
-	// Handle looping of the video
-	handleLooping();
 }
 
 void VideoComponent::renderSnapshot(const Transform4x4f& parentTrans)
@@ -281,8 +277,19 @@ void VideoComponent::startVideoWithDelay()
 
 void VideoComponent::update(int deltaTime)
 {
+	const bool wasPlaying = mIsPlaying;
+	const bool wasDelayed = mStartDelayed;
 	manageState();
 
+	// Handle the case where the video is delayed, and looping of the video. Not in render(), that only
+	// happens when something invalidated the window and a video that ended doesn't produce frames anymore
+	handleStartDelay();
+	handleLooping();
+
+	// switching between the video and the snapshot
+	if ((mIsPlaying != wasPlaying) || (mStartDelayed != wasDelayed))
+		mWindow->invalidate();
+
 	// If the video start is delayed and there is less than the fade time then set the image fade
 	// accordingly
 	if (mStartDelayed)
@@ -294,6 +301,7 @@ void VideoComponent::update(int deltaTime)
 			if (diff < FADE_TIME_MS)
 			{
 				mFadeIn = (float)diff / (float)FADE_TIME_MS;
+				mWindow->invalidate();
 				return;
 			}
 		}
@@ -304,6 +312,7 @@ void VideoComponent::update(int deltaTime)
 		mFadeIn += deltaTime / (float)FADE_TIME_MS;
 		if (mFadeIn > 1.0f)
 			mFadeIn = 1.0f;
+		mWindow->invalidate();
 	}
 	GuiComponent::update(deltaTime);
 }
@@ -312,7 +321,7 @@ void VideoComponent::manageState()
 {
 	// We will only show if the component is on display and the screensaver
 	// is not active
-	bool show = mShowing && !mScreensaverActive && !mDisable;
+	bool show = mShowing && !mScreensaverActive && !mDisable && !sPlaybackDisabled;
 
 	// See if we're already playing
 	if (mIsPlaying)
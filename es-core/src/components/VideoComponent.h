@@ -31,6 +31,8 @@ public:
 	bool setVideo(std::string path);
 	// Loads a static image that is displayed if the video cannot be played
 	void setImage(std::string path);
+	// Starts loading a static image in the background, see ImageComponent::prefetchImage
+	std::shared_ptr<TextureResource> prefetchImage(const std::string& path) { return mStaticImage.prefetchImage(path); }
 
 	// Configures the component to show the default video
 	void setDefaultVideo();
@@ -70,6 +72,9 @@ public:
 	virtual void setMaxSize(float width, float height) = 0;
 	inline void setMaxSize(const Vector2f& size) { setMaxSize(size.x(), size.y()); }
 
+	// Keeps every video on its static image, i.e. so benchmark runs don't depend on decoder threads
+	static void setPlaybackDisabled(bool disabled) { sPlaybackDisabled = disabled; }
+
 private:
 	// Start the video Immediately
 	virtual void startVideo() = 0;
@@ -108,6 +113,8 @@ protected:
 	bool							mTargetIsMax;
 
 	Configuration					mConfig;
+
+	static bool						sPlaybackDisabled;
 };
 
 #endif // ES_CORE_COMPONENTS_VIDEO_COMPONENT_H
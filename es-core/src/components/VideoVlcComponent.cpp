@@ -1,46 +1,124 @@
 #include "components/VideoVlcComponent.h"
 
 #include "resources/TextureResource.h"
+#include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
+#include "utils/ThreadPool.h"
 #include "PowerSaver.h"
 #include "Renderer.h"
 #include "Settings.h"
+#include "Window.h"
 #include <vlc/vlc.h>
 #include <SDL_mutex.h>
+#include <SDL_timer.h>
+#include <map>
+#include <mutex>
+#include <set>
 
 #ifdef WIN32
 #include <codecvt>
 #endif
 
 libvlc_instance_t* VideoVlcComponent::mVLC = NULL;
+std::list<VideoPlayer*> VideoVlcComponent::sIdlePlayers;
+VideoVlcComponent::PlayerPoolStats VideoVlcComponent::sPlayerPoolStats = { 0, 0, 0 };
+
+#define PROBE_RETRY_TIME 60000 // ms before a video without a video track is parsed again, it may have still been copied
+
+// The track size of every video that was parsed already, so starting one again doesn't wait on libvlc_media_parse.
+// Videos are parsed on a background thread, a path is pending from when it's queued until it's parsed or cancelled.
+static std::mutex						sProbeMutex;
+static std::map<std::string, Vector2i>	sProbedSizes;
+static std::map<std::string, unsigned>	sFailedProbes; // when they were parsed
+static std::set<std::string>			sPendingProbes;
+
+// Parses the media, blocking until it's done, and returns the size of its first video track
+static Vector2i probeVideoSize(libvlc_media_t* media)
+{
+	Vector2i size = Vector2i::Zero();
+
+	libvlc_media_parse(media);
+	libvlc_media_track_t** tracks;
+	unsigned track_count = libvlc_media_tracks_get(media, &tracks);
+	for (unsigned track = 0; track < track_count; ++track)
+	{
+		if (tracks[track]->i_type == libvlc_track_video)
+		{
+			size = Vector2i((int)tracks[track]->video->i_width, (int)tracks[track]->video->i_height);
+			break;
+		}
+	}
+	libvlc_media_tracks_release(tracks, track_count);
+
+	return size;
+}
+
+// Returns false if the video wasn't parsed yet, or a parse that found no video track is due to be retried
+static bool getProbedSize(const std::string& path, Vector2i& size)
+{
+	std::unique_lock<std::mutex> lock(sProbeMutex);
+
+	auto it = sProbedSizes.find(path);
+	if (it != sProbedSizes.cend())
+	{
+		size = it->second;
+		return true;
+	}
+
+	auto failed = sFailedProbes.find(path);
+	if (failed == sFailedProbes.cend())
+		return false;
+
+	if ((SDL_GetTicks() - failed->second) >= PROBE_RETRY_TIME)
+	{
+		sFailedProbes.erase(failed);
+		return false;
+	}
+
+	size = Vector2i::Zero();
+	return true;
+}
+
+// Drops a probe nobody is waiting for anymore, unless it's being parsed already
+static void cancelProbe(const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(sProbeMutex);
+	sPendingProbes.erase(path);
+}
 
 // VLC prepares to render a video frame.
 static void *lock(void *data, void **p_pixels) {
 	struct VideoContext *c = (struct VideoContext *)data;
 	SDL_LockMutex(c->mutex);
-	SDL_LockSurface(c->surface);
-	*p_pixels = c->surface->pixels;
-	return NULL; // Picture identifier, not needed here.
+	SDL_Surface* surface = c->surfaces[c->writeIndex];
+	SDL_UnlockMutex(c->mutex);
+	// The render thread never touches the surface being written, so decoding doesn't hold up rendering
+	SDL_LockSurface(surface);
+	*p_pixels = surface->pixels;
+	return surface; // Picture identifier, handed back to unlock and display.
 }
 
 // VLC just rendered a video frame.
-static void unlock(void *data, void* /*id*/, void *const* /*p_pixels*/) {
-	struct VideoContext *c = (struct VideoContext *)data;
-	SDL_UnlockSurface(c->surface);
-	SDL_UnlockMutex(c->mutex);
+static void unlock(void* /*data*/, void* id, void *const* /*p_pixels*/) {
+	SDL_UnlockSurface((SDL_Surface*)id);
 }
 
 // VLC wants to display a video frame.
-static void display(void* /*data*/, void* /*id*/) {
-	//Data to be displayed
+static void display(void *data, void* id) {
+	// Make it the frame to upload, and decode the next one into the other surface
+	struct VideoContext *c = (struct VideoContext *)data;
+	SDL_LockMutex(c->mutex);
+	c->frameIndex = (id == c->surfaces[0]) ? 0 : 1;
+	c->writeIndex = 1 - c->frameIndex;
+	c->newFrame = true;
+	SDL_UnlockMutex(c->mutex);
 }
 
 VideoVlcComponent::VideoVlcComponent(Window* window, std::string subtitles) :
 	VideoComponent(window),
-	mMediaPlayer(nullptr)
+	mPlayer(nullptr),
+	mWaitingForProbe(false)
 {
-	memset(&mContext, 0, sizeof(mContext));
-
 	// Get an empty texture for rendering the video
 	mTexture = TextureResource::get("");
 
@@ -59,6 +137,7 @@ void VideoVlcComponent::setResize(float width, float height)
 	mTargetIsMax = false;
 	mStaticImage.setResize(width, height);
 	resize();
+	updateOutputSize();
 }
 
 void VideoVlcComponent::setMaxSize(float width, float height)
@@ -67,6 +146,7 @@ void VideoVlcComponent::setMaxSize(float width, float height)
 	mTargetIsMax = true;
 	mStaticImage.setMaxSize(width, height);
 	resize();
+	updateOutputSize();
 }
 
 void VideoVlcComponent::resize()
@@ -129,6 +209,20 @@ void VideoVlcComponent::resize()
 	onSizeChanged();
 }
 
+void VideoVlcComponent::update(int deltaTime)
+{
+	VideoComponent::update(deltaTime);
+
+	// only redraw when VLC has finished a frame, not at the display's refresh rate
+	if (mIsPlaying && mPlayer)
+	{
+		SDL_LockMutex(mPlayer->context.mutex);
+		if (mPlayer->context.newFrame)
+			mWindow->invalidate();
+		SDL_UnlockMutex(mPlayer->context.mutex);
+	}
+}
+
 void VideoVlcComponent::render(const Transform4x4f& parentTrans)
 {
 	VideoComponent::render(parentTrans);
@@ -139,7 +233,7 @@ void VideoVlcComponent::render(const Transform4x4f& parentTrans)
 
 	Renderer::setMatrix(trans);
 
-	if (mIsPlaying && mContext.valid)
+	if (mIsPlaying && mPlayer)
 	{
 		float tex_offs_x = 0.0f;
 		float tex_offs_y = 0.0f;
@@ -185,10 +279,19 @@ void VideoVlcComponent::render(const Transform4x4f& parentTrans)
 				vertices[i / 4].colour[i % 4] = 1.0f;
 		}
 
+		Renderer::flush();
 		glEnable(GL_TEXTURE_2D);
 
-		// Build a texture for the video frame
-		mTexture->initFromPixels((unsigned char*)mContext.surface->pixels, mContext.surface->w, mContext.surface->h);
+		// Upload the latest frame if it's new, or if the texture was lost to a renderer reinit
+		VideoContext& context = mPlayer->context;
+		SDL_LockMutex(context.mutex);
+		if (context.newFrame || !mTexture->isLoaded())
+		{
+			SDL_Surface* frame = context.surfaces[context.frameIndex];
+			mTexture->updateFromPixels((unsigned char*)frame->pixels, frame->w, frame->h);
+			context.newFrame = false;
+		}
+		SDL_UnlockMutex(context.mutex);
 		mTexture->bind();
 
 		// Render it
@@ -212,28 +315,120 @@ void VideoVlcComponent::render(const Transform4x4f& parentTrans)
 	}
 }
 
-void VideoVlcComponent::setupContext()
+Vector2i VideoVlcComponent::getOutputSize() const
+{
+	const Vector2i sourceSize((int)mVideoWidth, (int)mVideoHeight);
+
+	// the screensaver already picked its size in startVideo(), with the captions in mind
+	if (mScreensaverMode)
+		return sourceSize;
+
+	// decoding more pixels than are drawn only costs copying and uploading them every frame
+	const Vector2i displaySize((int)Math::round(mSize.x()), (int)Math::round(mSize.y()));
+	if ((displaySize.x() <= 0) || (displaySize.y() <= 0))
+		return sourceSize;
+
+	return Vector2i(Math::min(displaySize.x(), sourceSize.x()), Math::min(displaySize.y(), sourceSize.y()));
+}
+
+void VideoVlcComponent::startPlayer()
+{
+	const Vector2i outputSize = getOutputSize();
+	mPlayer = checkoutPlayer((unsigned)outputSize.x(), (unsigned)outputSize.y());
+	libvlc_media_player_set_media(mPlayer->player, mMedia);
+
+	// A pooled player keeps the mute state of whatever it played before
+	libvlc_audio_set_mute(mPlayer->player, !Settings::getInstance()->getBool("VideoAudio"));
+
+	libvlc_media_player_play(mPlayer->player);
+}
+
+void VideoVlcComponent::updateOutputSize()
+{
+	if (!mPlayer)
+		return;
+
+	const Vector2i outputSize = getOutputSize();
+	if ((outputSize.x() == (int)mPlayer->width) && (outputSize.y() == (int)mPlayer->height))
+		return;
+
+	// The output size can't change while it's playing, so the video starts over on a player of the new size
+	returnPlayer(mPlayer);
+	startPlayer();
+}
+
+VideoPlayer* VideoVlcComponent::checkoutPlayer(unsigned width, unsigned height)
 {
-	if (!mContext.valid)
+	for (auto it = sIdlePlayers.begin(); it != sIdlePlayers.end(); it++)
 	{
-		// Create an RGBA surface to render the video into
-		mContext.surface = SDL_CreateRGBSurface(SDL_SWSURFACE, (int)mVideoWidth, (int)mVideoHeight, 32, 0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
-		mContext.mutex = SDL_CreateMutex();
-		mContext.valid = true;
-		resize();
+		VideoPlayer* player = *it;
+		if ((player->width == width) && (player->height == height))
+		{
+			sIdlePlayers.erase(it);
+			sPlayerPoolStats.reused++;
+
+			// The surfaces still hold the last frame of whatever it played before
+			for (int i = 0; i < 2; ++i)
+				SDL_FillRect(player->context.surfaces[i], NULL, 0);
+			player->context.writeIndex = 0;
+			player->context.frameIndex = 1;
+			player->context.newFrame = true;
+			return player;
+		}
 	}
+
+	VideoPlayer* player = new VideoPlayer();
+	player->width = width;
+	player->height = height;
+
+	// Create the RGBA surfaces to render the video into
+	for (int i = 0; i < 2; ++i)
+		player->context.surfaces[i] = SDL_CreateRGBSurface(SDL_SWSURFACE, (int)width, (int)height, 32, 0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
+	player->context.mutex = SDL_CreateMutex();
+	player->context.writeIndex = 0;
+	player->context.frameIndex = 1;
+	player->context.newFrame = true;
+
+	// The output is fixed for the life of the player, only the media changes
+	player->player = libvlc_media_player_new(mVLC);
+	libvlc_video_set_callbacks(player->player, lock, unlock, display, (void*)&player->context);
+	libvlc_video_set_format(player->player, "RGBA", (int)width, (int)height, (int)width * 4);
+
+	sPlayerPoolStats.created++;
+	return player;
 }
 
-void VideoVlcComponent::freeContext()
+void VideoVlcComponent::returnPlayer(VideoPlayer* player)
 {
-	if (mContext.valid)
+	// Stopping waits for the decoder, so it doesn't call back into the surfaces anymore after this
+	libvlc_media_player_stop(player->player);
+	sIdlePlayers.push_front(player);
+
+	const size_t poolSize = (size_t)Math::max(0, Settings::getInstance()->getInt("VideoPlayerPoolSize"));
+	while (sIdlePlayers.size() > poolSize)
 	{
-		SDL_FreeSurface(mContext.surface);
-		SDL_DestroyMutex(mContext.mutex);
-		mContext.valid = false;
+		releasePlayer(sIdlePlayers.back());
+		sIdlePlayers.pop_back();
 	}
 }
 
+void VideoVlcComponent::releasePlayer(VideoPlayer* player)
+{
+	libvlc_media_player_release(player->player);
+	for (int i = 0; i < 2; ++i)
+		SDL_FreeSurface(player->context.surfaces[i]);
+	SDL_DestroyMutex(player->context.mutex);
+	delete player;
+	sPlayerPoolStats.released++;
+}
+
+void VideoVlcComponent::releasePlayerPool()
+{
+	for (auto it = sIdlePlayers.cbegin(); it != sIdlePlayers.cend(); it++)
+		releasePlayer(*it);
+	sIdlePlayers.clear();
+}
+
 void VideoVlcComponent::setupVLC(std::string subtitles)
 {
 	// If VLC hasn't been initialised yet then do it now
@@ -258,20 +453,70 @@ void VideoVlcComponent::setupVLC(std::string subtitles)
 	}
 }
 
+void VideoVlcComponent::prefetchVideo(const std::string& path)
+{
+	if (!path.empty())
+		queueProbe(Utils::FileSystem::getCanonicalPath(path));
+}
+
+void VideoVlcComponent::queueProbe(const std::string& path)
+{
+	if (!mVLC || path.empty())
+		return;
+
+	// a parse that failed a while ago is dropped, so it's retried
+	Vector2i size;
+	if (getProbedSize(path, size))
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(sProbeMutex);
+		if (!sPendingProbes.insert(path).second)
+			return;
+	}
+
+	// one thread is plenty, what's parsed is shown one at a time
+	static Utils::ThreadPool sProbePool(1);
+	sProbePool.queueWorkItem([path] {
+		{
+			// skip it if it was cancelled while it was queued, i.e. the cursor moved on
+			std::unique_lock<std::mutex> lock(sProbeMutex);
+			if (sPendingProbes.find(path) == sPendingProbes.cend())
+				return;
+		}
+
+#ifdef WIN32
+		libvlc_media_t* media = libvlc_media_new_path(mVLC, Utils::String::replace(path, "/", "\\").c_str());
+#else
+		libvlc_media_t* media = libvlc_media_new_path(mVLC, path.c_str());
+#endif
+		Vector2i size = Vector2i::Zero();
+		if (media)
+		{
+			size = probeVideoSize(media);
+			libvlc_media_release(media);
+		}
+
+		std::unique_lock<std::mutex> lock(sProbeMutex);
+		sPendingProbes.erase(path);
+		if ((size.x() > 0) && (size.y() > 0))
+			sProbedSizes[path] = size;
+		else
+			sFailedProbes[path] = SDL_GetTicks();
+	});
+}
+
 void VideoVlcComponent::handleLooping()
 {
-	if (mIsPlaying && mMediaPlayer)
+	if (mIsPlaying && mPlayer)
 	{
-		libvlc_state_t state = libvlc_media_player_get_state(mMediaPlayer);
+		libvlc_state_t state = libvlc_media_player_get_state(mPlayer->player);
 		if (state == libvlc_Ended)
 		{
-			if (!Settings::getInstance()->getBool("VideoAudio"))
-			{
-				libvlc_audio_set_mute(mMediaPlayer, 1);
-			}
-			//libvlc_media_player_set_position(mMediaPlayer, 0.0f);
-			libvlc_media_player_set_media(mMediaPlayer, mMedia);
-			libvlc_media_player_play(mMediaPlayer);
+			libvlc_audio_set_mute(mPlayer->player, !Settings::getInstance()->getBool("VideoAudio"));
+			//libvlc_media_player_set_position(mPlayer->player, 0.0f);
+			libvlc_media_player_set_media(mPlayer->player, mMedia);
+			libvlc_media_player_play(mPlayer->player);
 		}
 	}
 }
@@ -293,28 +538,29 @@ void VideoVlcComponent::startVideo()
 			// Set the video that we are going to be playing so we don't attempt to restart it
 			mPlayingVideoPath = mVideoPath;
 
-			// Open the media
-			mMedia = libvlc_media_new_path(mVLC, path.c_str());
-			if (mMedia)
+			// We need the size of the video track to find the aspect ratio, but parsing can take a while on slow
+			// storage. So it's parsed in the background and the start stays delayed, showing the snapshot, until then.
+			Vector2i size;
+			if (!getProbedSize(mVideoPath, size))
 			{
-				unsigned track_count;
-				// Get the media metadata so we can find the aspect ratio
-				libvlc_media_parse(mMedia);
-				libvlc_media_track_t** tracks;
-				track_count = libvlc_media_tracks_get(mMedia, &tracks);
-				for (unsigned track = 0; track < track_count; ++track)
-				{
-					if (tracks[track]->i_type == libvlc_track_video)
-					{
-						mVideoWidth = tracks[track]->video->i_width;
-						mVideoHeight = tracks[track]->video->i_height;
-						break;
-					}
-				}
-				libvlc_media_tracks_release(tracks, track_count);
+				queueProbe(mVideoPath);
+				mWaitingForProbe = true;
+				mStartDelayed = true;
+				mStartTime = SDL_GetTicks();
+				mIsPlaying = true;
+				return;
+			}
+			mWaitingForProbe = false;
+
+			mVideoWidth = (unsigned)size.x();
+			mVideoHeight = (unsigned)size.y();
 
-				// Make sure we found a valid video track
-				if ((mVideoWidth > 0) && (mVideoHeight > 0))
+			// Make sure we found a valid video track
+			if ((mVideoWidth > 0) && (mVideoHeight > 0))
+			{
+				// Open the media
+				mMedia = libvlc_media_new_path(mVLC, path.c_str());
+				if (mMedia)
 				{
 #ifndef _RPI_
 					if (mScreensaverMode)
@@ -335,19 +581,10 @@ void VideoVlcComponent::startVideo()
 					}
 #endif
 					PowerSaver::pause();
-					setupContext();
 
-					// Setup the media player
-					mMediaPlayer = libvlc_media_player_new_from_media(mMedia);
-
-					if (!Settings::getInstance()->getBool("VideoAudio"))
-					{
-						libvlc_audio_set_mute(mMediaPlayer, 1);
-					}
-
-					libvlc_media_player_play(mMediaPlayer);
-					libvlc_video_set_callbacks(mMediaPlayer, lock, unlock, display, (void*)&mContext);
-					libvlc_video_set_format(mMediaPlayer, "RGBA", (int)mVideoWidth, (int)mVideoHeight, (int)mVideoWidth * 4);
+					// Setup the media player, the size it's drawn at decides the size it's decoded at
+					resize();
+					startPlayer();
 
 					// Update the playing state
 					mIsPlaying = true;
@@ -362,14 +599,17 @@ void VideoVlcComponent::stopVideo()
 {
 	mIsPlaying = false;
 	mStartDelayed = false;
-	// Release the media player so it stops calling back to us
-	if (mMediaPlayer)
+	if (mWaitingForProbe)
+	{
+		cancelProbe(mPlayingVideoPath);
+		mWaitingForProbe = false;
+	}
+	// Hand the media player back so it stops calling back to us
+	if (mPlayer)
 	{
-		libvlc_media_player_stop(mMediaPlayer);
-		libvlc_media_player_release(mMediaPlayer);
+		returnPlayer(mPlayer);
 		libvlc_media_release(mMedia);
-		mMediaPlayer = NULL;
-		freeContext();
+		mPlayer = NULL;
 		PowerSaver::resume();
 	}
 }
@@ -3,6 +3,7 @@
 #define ES_CORE_COMPONENTS_VIDEO_VLC_COMPONENT_H
 
 #include "VideoComponent.h"
+#include <list>
 
 struct SDL_mutex;
 struct SDL_Surface;
@@ -10,10 +11,21 @@ struct libvlc_instance_t;
 struct libvlc_media_t;
 struct libvlc_media_player_t;
 
+// VLC decodes into one surface while the other holds the latest complete frame, they swap when a frame is done
 struct VideoContext {
-	SDL_Surface*		surface;
-	SDL_mutex*			mutex;
-	bool				valid;
+	SDL_Surface*		surfaces[2];
+	SDL_mutex*			mutex;		// guards the indices and the frame surface while it's uploaded
+	int					writeIndex;	// the surface VLC decodes into
+	int					frameIndex;	// the surface with the latest complete frame
+	bool				newFrame;	// the frame surface hasn't been uploaded yet
+};
+
+// A media player and the surfaces it decodes into, they're set up for one video size and shared through a pool
+struct VideoPlayer {
+	libvlc_media_player_t*	player;
+	VideoContext			context;
+	unsigned				width;
+	unsigned				height;
 };
 
 class VideoVlcComponent : public VideoComponent
@@ -28,11 +40,23 @@ class VideoVlcComponent : public VideoComponent
 	};
 
 public:
+	struct PlayerPoolStats
+	{
+		unsigned int created; // players set up for a video size that had none idle
+		unsigned int reused; // players that were idle in the pool
+		unsigned int released; // players that didn't fit in the pool anymore
+	};
+
 	static void setupVLC(std::string subtitles);
+	// Parses the video on a background thread so starting it later doesn't have to
+	static void prefetchVideo(const std::string& path);
+	// Releases the idle players, the ones in use go back to the pool when their video stops
+	static void releasePlayerPool();
 
 	VideoVlcComponent(Window* window, std::string subtitles);
 	virtual ~VideoVlcComponent();
 
+	void update(int deltaTime) override;
 	void render(const Transform4x4f& parentTrans) override;
 
 
@@ -47,6 +71,8 @@ public:
 	// Never breaks the aspect ratio. setMaxSize() and setResize() are mutually exclusive.
 	void setMaxSize(float width, float height);
 
+	static const PlayerPoolStats& getPlayerPoolStats() { return sPlayerPoolStats; }
+
 private:
 	// Calculates the correct mSize from our resizing information (set by setResize/setMaxSize).
 	// Used internally whenever the resizing parameters or texture change.
@@ -58,14 +84,29 @@ private:
 	// Handle looping the video. Must be called periodically
 	virtual void handleLooping();
 
-	void setupContext();
-	void freeContext();
+	// The size VLC decodes the video at, the size it's drawn at unless that's larger than the video
+	Vector2i getOutputSize() const;
+	// Sets up a player at the output size and starts mMedia on it
+	void startPlayer();
+	// Moves the video to a player of the new output size after the component was resized
+	void updateOutputSize();
+
+	// Takes an idle player of this size from the pool, or sets up a new one
+	static VideoPlayer* checkoutPlayer(unsigned width, unsigned height);
+	// Stops the player and puts it back in the pool, releasing the least recently used ones that don't fit
+	static void returnPlayer(VideoPlayer* player);
+	static void releasePlayer(VideoPlayer* player);
+
+	// Parses the video on the background thread, unless it was parsed or queued already
+	static void queueProbe(const std::string& path);
 
 private:
 	static libvlc_instance_t*		mVLC;
+	static std::list<VideoPlayer*>	sIdlePlayers; // most recently returned first
+	static PlayerPoolStats			sPlayerPoolStats;
 	libvlc_media_t*					mMedia;
-	libvlc_media_player_t*			mMediaPlayer;
-	VideoContext					mContext;
+	VideoPlayer*					mPlayer;
+	bool							mWaitingForProbe;
 	std::shared_ptr<TextureResource> mTexture;
 };
 
@@ -329,6 +329,7 @@ void GuiInputConfig::update(int deltaTime)
 			clearAssignment(mHeldInputId);
 			mHoldingInput = false;
 			rowDone();
+			mWindow->invalidate();
 		}else{
 			if(prevSec != curSec)
 			{
@@ -338,6 +339,7 @@ void GuiInputConfig::update(int deltaTime)
 				ss << "HOLD FOR " << HOLD_TO_SKIP_MS/1000 - curSec << "S TO SKIP";
 				text->setText(ss.str());
 				text->setColor(0x777777FF);
+				mWindow->invalidate();
 			}
 		}
 	}
@@ -1,11 +1,30 @@
 #include "resources/Font.h"
 
+#include "math/Transform4x4f.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Renderer.h"
+#include <fstream>
+#include <sstream>
+#include <string.h>
+
+// faces stay open between text builds, this bounds the memory their font files take across all fonts
+#define FACE_CACHE_BUDGET (16 * 1024 * 1024)
+
+// bump this whenever the layout written by saveGlyphAtlas() changes
+#define GLYPH_ATLAS_VERSION 1
+static const char GLYPH_ATLAS_MAGIC[] = "ESGLYPH";
+// glyphs are only ever added to an atlas, a cached one with more textures than this is dropped and starts over from ASCII
+#define GLYPH_ATLAS_MAX_TEXTURES 4
 
 FT_Library Font::sLibrary = NULL;
+size_t Font::sFaceCacheSize = 0;
+unsigned int Font::sFaceCacheTick = 0;
+Font::TextBatchStats Font::sTextBatchStats = { 0, 0 };
+Font::TextBatchStats Font::sLastFrameTextBatchStats = { 0, 0 };
+std::vector<Font::TextBatchList> Font::sTextBatch;
 
 int Font::getSize() const { return mSize; }
 
@@ -73,20 +92,24 @@ Font::Font(int size, const std::string& path) : mSize(size), mPath(path)
 	assert(mSize > 0);
 	
 	mMaxGlyphHeight = 0;
+	mFaceCacheTick = 0;
+	mAtlasDirty = false;
 
 	if(!sLibrary)
 		initLibrary();
 
+	// glyphs rendered on an earlier run are read back from the atlas cache
+	loadGlyphAtlas();
+
 	// always initialize ASCII characters
 	for(unsigned int i = 32; i < 128; i++)
 		getGlyph(i);
-
-	clearFaceCache();
 }
 
 Font::~Font()
 {
 	unload(ResourceManager::getInstance());
+	clearFaceCache();
 }
 
 void Font::reload(std::shared_ptr<ResourceManager>& /*rm*/)
@@ -119,9 +142,15 @@ std::shared_ptr<Font> Font::get(int size, const std::string& path)
 
 void Font::unloadTextures()
 {
+	// once the atlas cache is up to date the pixels don't need to stay in memory, rebuildTextures() reads them back
+	if(mAtlasDirty)
+		mAtlasDirty = !saveGlyphAtlas();
+
 	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
 	{
 		it->deinitTexture();
+		if(!mAtlasDirty)
+			std::vector<unsigned char>().swap(it->pixels);
 	}
 }
 
@@ -184,7 +213,7 @@ void Font::FontTexture::initTexture()
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, textureSize.x(), textureSize.y(), 0, GL_ALPHA, GL_UNSIGNED_BYTE, NULL);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, textureSize.x(), textureSize.y(), 0, GL_ALPHA, GL_UNSIGNED_BYTE, pixels.empty() ? NULL : pixels.data());
 }
 
 void Font::FontTexture::deinitTexture()
@@ -212,6 +241,7 @@ void Font::getTextureForNewGlyph(const Vector2i& glyphSize, FontTexture*& tex_ou
 	// make a new one
 	mTextures.push_back(FontTexture());
 	tex_out = &mTextures.back();
+	tex_out->pixels.assign(tex_out->textureSize.x() * tex_out->textureSize.y(), 0);
 	tex_out->initTexture();
 	
 	bool ok = tex_out->findEmpty(glyphSize, cursor_out);
@@ -280,6 +310,8 @@ FT_Face Font::getFaceForChar(unsigned int id)
 {
 	static const std::vector<std::string> fallbackFonts = getFallbackFontPaths();
 
+	mFaceCacheTick = ++sFaceCacheTick;
+
 	// look through our current font + fallback fonts to see if any have the glyph we're looking for
 	for(unsigned int i = 0; i < fallbackFonts.size() + 1; i++)
 	{
@@ -291,6 +323,8 @@ FT_Face Font::getFaceForChar(unsigned int id)
 			// otherwise, take from fallbackFonts
 			const std::string& path = (i == 0 ? mPath : fallbackFonts.at(i - 1));
 			ResourceData data = ResourceManager::getInstance()->getFileData(path);
+			trimFaceCaches(data.length, this);
+			sFaceCacheSize += data.length;
 			mFaceCache[i] = std::unique_ptr<FontFace>(new FontFace(std::move(data), mSize));
 			fit = mFaceCache.find(i);
 		}
@@ -305,9 +339,33 @@ FT_Face Font::getFaceForChar(unsigned int id)
 
 void Font::clearFaceCache()
 {
+	for(auto it = mFaceCache.cbegin(); it != mFaceCache.cend(); it++)
+		sFaceCacheSize -= it->second->data.length;
+
 	mFaceCache.clear();
 }
 
+void Font::trimFaceCaches(size_t needed, const Font* keep)
+{
+	while(sFaceCacheSize + needed > FACE_CACHE_BUDGET)
+	{
+		// close the faces of the font that went the longest without needing one
+		std::shared_ptr<Font> oldest;
+		for(auto it = sFontMap.cbegin(); it != sFontMap.cend(); it++)
+		{
+			std::shared_ptr<Font> font = it->second.lock();
+			if(font && font.get() != keep && !font->mFaceCache.empty() && (!oldest || font->mFaceCacheTick < oldest->mFaceCacheTick))
+				oldest = font;
+		}
+
+		// only the faces of keep are left, it's allowed to go over the budget
+		if(!oldest)
+			break;
+
+		oldest->clearFaceCache();
+	}
+}
+
 Font::Glyph* Font::getGlyph(unsigned int id)
 {
 	// is it already loaded?
@@ -355,9 +413,8 @@ Font::Glyph* Font::getGlyph(unsigned int id)
 	glyph.bearing = Vector2f((float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f);
 
 	// upload glyph bitmap to texture
-	glBindTexture(GL_TEXTURE_2D, tex->textureId);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, g->bitmap.buffer);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	writeGlyphBitmap(tex, cursor, glyphSize, g->bitmap);
+	mAtlasDirty = true;
 
 	// update max glyph height
 	if(glyphSize.y() > mMaxGlyphHeight)
@@ -367,15 +424,51 @@ Font::Glyph* Font::getGlyph(unsigned int id)
 	return &glyph;
 }
 
+void Font::writeGlyphBitmap(FontTexture* tex, const Vector2i& cursor, const Vector2i& glyphSize, const FT_Bitmap& bitmap)
+{
+	// keep a copy of it for the atlas cache
+	for(int y = 0; !tex->pixels.empty() && (y < glyphSize.y()); y++)
+		memcpy(&tex->pixels[(cursor.y() + y) * tex->textureSize.x() + cursor.x()], bitmap.buffer + y * bitmap.pitch, glyphSize.x());
+
+	glBindTexture(GL_TEXTURE_2D, tex->textureId);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, bitmap.buffer);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 // completely recreate the texture data for all textures based on mGlyphs information
 void Font::rebuildTextures()
 {
+	// the pixels were dropped when the textures were unloaded, read them back from the atlas cache
+	bool restored = true;
+	if(!mTextures.empty() && mTextures.front().pixels.empty())
+	{
+		std::vector<FontTexture> textures;
+		std::map<unsigned int, Glyph> glyphs;
+		int maxGlyphHeight = 0;
+
+		// glyphs are only ever added, so the same counts mean it's the atlas that was saved when unloading
+		restored = readGlyphAtlas(textures, glyphs, maxGlyphHeight) && (textures.size() == mTextures.size()) && (glyphs.size() == mGlyphMap.size());
+
+		for(unsigned int i = 0; i < mTextures.size(); i++)
+		{
+			if(restored)
+				mTextures[i].pixels.swap(textures[i].pixels);
+			else
+				mTextures[i].pixels.assign(mTextures[i].textureSize.x() * mTextures[i].textureSize.y(), 0);
+		}
+	}
+
 	// recreate OpenGL textures
 	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
 	{
 		it->initTexture();
 	}
 
+	if(restored)
+		return;
+
+	LOG(LogWarning) << "Glyph atlas cache for font " << mPath << ", size " << mSize << " is missing or out of date, rendering its glyphs again";
+
 	// reupload the texture data
 	for(auto it = mGlyphMap.cbegin(); it != mGlyphMap.cend(); it++)
 	{
@@ -389,14 +482,201 @@ void Font::rebuildTextures()
 		
 		// find the position/size
 		Vector2i cursor((int)(it->second.texPos.x() * tex->textureSize.x()), (int)(it->second.texPos.y() * tex->textureSize.y()));
-		Vector2i glyphSize((int)(it->second.texSize.x() * tex->textureSize.x()), (int)(it->second.texSize.y() * tex->textureSize.y()));
+		Vector2i glyphSize(glyphSlot->bitmap.width, glyphSlot->bitmap.rows);
 		
 		// upload to texture
-		glBindTexture(GL_TEXTURE_2D, tex->textureId);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, glyphSlot->bitmap.buffer);
+		writeGlyphBitmap(tex, cursor, glyphSize, glyphSlot->bitmap);
 	}
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	mAtlasDirty = true;
+}
+
+static void writeInt(std::ostream& stream, long long value)
+{
+	stream.write((const char*)&value, sizeof(value));
+}
+
+static long long readInt(std::istream& stream)
+{
+	long long value = 0;
+	stream.read((char*)&value, sizeof(value));
+	return value;
+}
+
+static void writeVector(std::ostream& stream, const Vector2f& value)
+{
+	const float xy[2] = { value.x(), value.y() };
+	stream.write((const char*)xy, sizeof(xy));
+}
+
+static Vector2f readVector(std::istream& stream)
+{
+	float xy[2] = { 0.0f, 0.0f };
+	stream.read((char*)xy, sizeof(xy));
+	return Vector2f(xy[0], xy[1]);
+}
+
+// the header identifies the font file and its state when the atlas was saved, the atlas follows it
+static void writeGlyphAtlasHeader(std::ostream& stream, const std::string& path, int size)
+{
+	stream.write(GLYPH_ATLAS_MAGIC, sizeof(GLYPH_ATLAS_MAGIC));
+	writeInt(stream, GLYPH_ATLAS_VERSION);
+	writeInt(stream, (long long)path.size());
+	stream.write(path.data(), path.size());
+	writeInt(stream, (long long)Utils::FileSystem::getModificationTime(path));
+	writeInt(stream, (long long)Utils::FileSystem::getFileSize(path));
+	writeInt(stream, size);
+}
+
+std::string Font::getGlyphAtlasPath() const
+{
+	std::stringstream ss;
+	ss << Utils::FileSystem::getHomePath() << "/.emulationstation/cache/fonts/" << std::hex << std::hash<std::string>()(mPath) <<
+		std::dec << "_" << mSize << ".bin";
+	return ss.str();
+}
+
+bool Font::readGlyphAtlas(std::vector<FontTexture>& textures, std::map<unsigned int, Glyph>& glyphs, int& maxGlyphHeight)
+{
+	std::ifstream file(getGlyphAtlasPath().c_str(), std::ios::in | std::ios::binary);
+	if(!file.is_open())
+		return false;
+
+	// the stored header has to match the one we'd write for the font as it is now
+	std::stringstream expected;
+	writeGlyphAtlasHeader(expected, mPath, mSize);
+	const std::string header = expected.str();
+
+	std::string stored(header.size(), '\0');
+	file.read(&stored[0], stored.size());
+	if(file.fail() || stored != header)
+		return false;
+
+	maxGlyphHeight = (int)readInt(file);
+	const long long textureCount = readInt(file);
+	if(file.fail() || textureCount < 0 || textureCount > 64)
+		return false;
+
+	textures.resize((size_t)textureCount);
+	for(auto it = textures.begin(); it != textures.end(); it++)
+	{
+		const int width = (int)readInt(file);
+		const int height = (int)readInt(file);
+		const int writeX = (int)readInt(file);
+		const int writeY = (int)readInt(file);
+		it->rowHeight = (int)readInt(file);
+		if(file.fail() || width <= 0 || height <= 0 || width > 8192 || height > 8192)
+			return false;
+
+		it->textureSize = Vector2i(width, height);
+		it->writePos = Vector2i(writeX, writeY);
+	}
+
+	// the glyph map holds the codepoint set the atlas was built for
+	const long long glyphCount = readInt(file);
+	if(file.fail() || glyphCount < 0)
+		return false;
+
+	for(long long i = 0; i < glyphCount; i++)
+	{
+		const unsigned int id = (unsigned int)readInt(file);
+		const long long textureIndex = readInt(file);
+		if(file.fail() || textureIndex < 0 || textureIndex >= textureCount)
+			return false;
+
+		Glyph& glyph = glyphs[id];
+		glyph.texture = &textures[(size_t)textureIndex];
+		glyph.texPos = readVector(file);
+		glyph.texSize = readVector(file);
+		glyph.advance = readVector(file);
+		glyph.bearing = readVector(file);
+	}
+
+	for(auto it = textures.begin(); it != textures.end(); it++)
+	{
+		it->pixels.resize(it->textureSize.x() * it->textureSize.y());
+		file.read((char*)it->pixels.data(), it->pixels.size());
+	}
+
+	return !file.fail();
+}
+
+void Font::loadGlyphAtlas()
+{
+	std::vector<FontTexture> textures;
+	std::map<unsigned int, Glyph> glyphs;
+	int maxGlyphHeight = 0;
+
+	if(!readGlyphAtlas(textures, glyphs, maxGlyphHeight))
+		return;
+
+	// the ASCII glyphs added by the constructor mark it dirty, so the next save replaces it
+	if(textures.size() > GLYPH_ATLAS_MAX_TEXTURES)
+	{
+		LOG(LogInfo) << "Glyph atlas cache for font " << mPath << ", size " << mSize << " has " << textures.size() << " textures, rebuilding it";
+		return;
+	}
+
+	mTextures = textures;
+	for(auto it = glyphs.begin(); it != glyphs.end(); it++)
+		it->second.texture = &mTextures[it->second.texture - &textures[0]];
+
+	mGlyphMap = glyphs;
+	mMaxGlyphHeight = maxGlyphHeight;
+
+	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
+		it->initTexture();
+}
+
+bool Font::saveGlyphAtlas()
+{
+	const std::string cachePath = getGlyphAtlasPath();
+	const std::string tempPath = cachePath + ".tmp";
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(cachePath));
+
+	std::ofstream file(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	writeGlyphAtlasHeader(file, mPath, mSize);
+	writeInt(file, mMaxGlyphHeight);
+	writeInt(file, (long long)mTextures.size());
+	for(auto it = mTextures.cbegin(); it != mTextures.cend(); it++)
+	{
+		writeInt(file, it->textureSize.x());
+		writeInt(file, it->textureSize.y());
+		writeInt(file, it->writePos.x());
+		writeInt(file, it->writePos.y());
+		writeInt(file, it->rowHeight);
+	}
+
+	bool valid = true;
+	writeInt(file, (long long)mGlyphMap.size());
+	for(auto it = mGlyphMap.cbegin(); it != mGlyphMap.cend(); it++)
+	{
+		const long long textureIndex = it->second.texture - mTextures.data();
+		valid = valid && (textureIndex >= 0) && (textureIndex < (long long)mTextures.size());
+
+		writeInt(file, it->first);
+		writeInt(file, textureIndex);
+		writeVector(file, it->second.texPos);
+		writeVector(file, it->second.texSize);
+		writeVector(file, it->second.advance);
+		writeVector(file, it->second.bearing);
+	}
+
+	for(auto it = mTextures.cbegin(); it != mTextures.cend(); it++)
+	{
+		valid = valid && (it->pixels.size() == (size_t)(it->textureSize.x() * it->textureSize.y()));
+		file.write((const char*)it->pixels.data(), it->pixels.size());
+	}
+	file.close();
+
+	if(!valid || file.fail() || !Utils::FileSystem::renameFile(tempPath, cachePath))
+	{
+		LOG(LogError) << "Error writing glyph atlas cache \"" << cachePath << "\" (for font " << mPath << ", size " << mSize << ")!";
+		Utils::FileSystem::removeFile(tempPath);
+		return false;
+	}
+
+	return true;
 }
 
 void Font::renderTextCache(TextCache* cache)
@@ -407,34 +687,98 @@ void Font::renderTextCache(TextCache* cache)
 		return;
 	}
 
+	// triangles submitted before have to stay underneath
+	Renderer::flushTriangles();
+
+	const Transform4x4f& trans = Renderer::getMatrix();
+	sTextBatchStats.caches++;
+
 	for(auto it = cache->vertexLists.cbegin(); it != cache->vertexLists.cend(); it++)
 	{
 		assert(*it->textureIdPtr != 0);
 
-		auto vertexList = *it;
+		TextBatchList& list = getTextBatchList(*it->textureIdPtr);
+		for(auto vert = it->verts.cbegin(); vert != it->verts.cend(); vert++)
+		{
+			const Vector3f pos = trans * Vector3f(vert->pos.x(), vert->pos.y(), 0.0f);
+			list.verts.push_back(Vector2f(pos.x(), pos.y()));
+			list.verts.push_back(vert->tex);
+		}
+		list.colors.insert(list.colors.cend(), it->colors.cbegin(), it->colors.cend());
+	}
+}
+
+void Font::flushTextBatch()
+{
+	bool drawn = false;
+	for(auto it = sTextBatch.begin(); it != sTextBatch.end(); it++)
+	{
+		if(it->verts.empty())
+			continue;
 
-		glBindTexture(GL_TEXTURE_2D, *it->textureIdPtr);
-		glEnable(GL_TEXTURE_2D);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		// the vertices are transformed already
+		if(!drawn)
+		{
+			glLoadIdentity();
+
+			glEnable(GL_TEXTURE_2D);
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glEnableClientState(GL_COLOR_ARRAY);
+
+			drawn = true;
+		}
 
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
+		glBindTexture(GL_TEXTURE_2D, it->textureId);
 
-		glVertexPointer(2, GL_FLOAT, sizeof(TextCache::Vertex), &it->verts[0].pos);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(TextCache::Vertex), &it->verts[0].tex);
+		glVertexPointer(2, GL_FLOAT, sizeof(Vector2f) * 2, &it->verts[0]);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(Vector2f) * 2, &it->verts[1]);
 		glColorPointer(4, GL_UNSIGNED_BYTE, 0, it->colors.data());
 
-		glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(it->verts.size()));
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(it->verts.size() / 2));
+		sTextBatchStats.drawCalls++;
 
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+		it->verts.clear();
+		it->colors.clear();
+	}
+
+	if(!drawn)
+		return;
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_BLEND);
+
+	Renderer::setMatrix(Renderer::getMatrix());
+}
+
+void Font::endTextBatchFrame()
+{
+	sLastFrameTextBatchStats = sTextBatchStats;
+	sTextBatchStats = { 0, 0 };
 
-		glDisable(GL_TEXTURE_2D);
-		glDisable(GL_BLEND);
+	// forget the textures that weren't drawn this frame, they may be gone already
+	sTextBatch.clear();
+}
+
+Font::TextBatchList& Font::getTextBatchList(GLuint textureId)
+{
+	// there's only a handful of font textures, and drawing them in the order they were first used keeps overlaps stable
+	for(auto it = sTextBatch.begin(); it != sTextBatch.end(); it++)
+	{
+		if(it->textureId == textureId)
+			return *it;
 	}
+
+	sTextBatch.push_back(TextBatchList());
+	sTextBatch.back().textureId = textureId;
+	return sTextBatch.back();
 }
 
 Vector2f Font::sizeText(std::string text, float lineSpacing)
@@ -598,6 +942,8 @@ float Font::getNewlineStartOffset(const std::string& text, const unsigned int& c
 
 TextCache* Font::buildTextCache(const std::string& text, Vector2f offset, unsigned int color, float xLen, Alignment alignment, float lineSpacing)
 {
+	Profiler::ScopedTimer timer("text", "Font::buildTextCache");
+
 	float x = offset[0] + (xLen != 0 ? getNewlineStartOffset(text, 0, xLen, alignment) : 0);
 	
 	float yTop = getGlyph('S')->bearing.y();
@@ -682,8 +1028,6 @@ TextCache* Font::buildTextCache(const std::string& text, Vector2f offset, unsign
 		Renderer::buildGLColorArray(vertList.colors.data(), color, (unsigned int)(it->second.size()));
 	}
 
-	clearFaceCache();
-
 	return cache;
 }
 
@@ -44,7 +44,18 @@ public:
 	Vector2f sizeText(std::string text, float lineSpacing = 1.5f); // Returns the expected size of a string when rendered.  Extra spacing is applied to the Y axis.
 	TextCache* buildTextCache(const std::string& text, float offsetX, float offsetY, unsigned int color);
 	TextCache* buildTextCache(const std::string& text, Vector2f offset, unsigned int color, float xLen, Alignment alignment = ALIGN_LEFT, float lineSpacing = 1.5f);
-	void renderTextCache(TextCache* cache);
+	void renderTextCache(TextCache* cache); // adds it to the text batch with the current Renderer matrix, it's drawn on the next Renderer::flush()
+
+	// The text batch merges the vertices of every TextCache rendered since the last flush by font texture,
+	// transformed on the CPU, so each texture takes a single draw call no matter how many strings use it
+	struct TextBatchStats
+	{
+		unsigned int caches;    // TextCaches rendered
+		unsigned int drawCalls; // draw calls it took
+	};
+	static void flushTextBatch();
+	static void endTextBatchFrame(); // starts counting a new frame
+	static const TextBatchStats& getTextBatchStats() { return sLastFrameTextBatchStats; } // of the last complete frame
 	
 	std::string wrapText(std::string text, float xLen); // Inserts newlines into text to make it wrap properly.
 	Vector2f sizeWrappedText(std::string text, float xLen, float lineSpacing = 1.5f); // Returns the expected size of a string after wrapping is applied.
@@ -69,6 +80,19 @@ public:
 private:
 	static FT_Library sLibrary;
 	static std::map< std::pair<std::string, int>, std::weak_ptr<Font> > sFontMap;
+	static size_t sFaceCacheSize; // bytes of font files held open by the face caches of all fonts
+	static unsigned int sFaceCacheTick;
+	static TextBatchStats sTextBatchStats;
+	static TextBatchStats sLastFrameTextBatchStats;
+
+	struct TextBatchList
+	{
+		GLuint textureId;
+		std::vector<Vector2f> verts; // position and texture coordinate of each vertex, interleaved
+		std::vector<GLubyte> colors;
+	};
+	static std::vector<TextBatchList> sTextBatch;
+	static TextBatchList& getTextBatchList(GLuint textureId);
 
 	Font(int size, const std::string& path);
 
@@ -80,12 +104,14 @@ private:
 		Vector2i writePos;
 		int rowHeight;
 
+		std::vector<unsigned char> pixels; // copy of the texture's alpha values, dropped while the texture is unloaded
+
 		FontTexture();
 		~FontTexture();
 		bool findEmpty(const Vector2i& size, Vector2i& cursor_out);
 
 		// you must call initTexture() after creating a FontTexture to get a textureId
-		void initTexture(); // initializes the OpenGL texture according to this FontTexture's settings, updating textureId
+		void initTexture(); // initializes the OpenGL texture according to this FontTexture's settings and pixels, updating textureId
 		void deinitTexture(); // deinitializes the OpenGL texture if any exists, is automatically called in the destructor
 	};
 
@@ -106,8 +132,10 @@ private:
 	void getTextureForNewGlyph(const Vector2i& glyphSize, FontTexture*& tex_out, Vector2i& cursor_out);
 
 	std::map< unsigned int, std::unique_ptr<FontFace> > mFaceCache;
+	unsigned int mFaceCacheTick; // sFaceCacheTick when this font last looked for a face
 	FT_Face getFaceForChar(unsigned int id);
 	void clearFaceCache();
+	static void trimFaceCaches(size_t needed, const Font* keep); // closes the faces of the least recently used fonts until needed fits in the budget
 
 	struct Glyph
 	{
@@ -123,6 +151,16 @@ private:
 	std::map<unsigned int, Glyph> mGlyphMap;
 
 	Glyph* getGlyph(unsigned int id);
+	static void writeGlyphBitmap(FontTexture* tex, const Vector2i& cursor, const Vector2i& glyphSize, const FT_Bitmap& bitmap);
+
+	// The glyph atlas (textures and glyph map) is kept on disk, keyed by the font's path and size, so
+	// glyphs rendered once are read back instead of going through FreeType again, both after returning
+	// from a game and on the next start
+	bool mAtlasDirty; // glyphs were added since the atlas was last saved or loaded
+	bool readGlyphAtlas(std::vector<FontTexture>& textures, std::map<unsigned int, Glyph>& glyphs, int& maxGlyphHeight);
+	void loadGlyphAtlas();
+	bool saveGlyphAtlas();
+	std::string getGlyphAtlasPath() const;
 
 	int mMaxGlyphHeight;
 	
@@ -2,19 +2,51 @@
 
 #include "math/Misc.h"
 #include "resources/ResourceManager.h"
+#include "resources/ThumbnailCache.h"
 #include "ImageIO.h"
 #include "Log.h"
 #include "platform.h"
+#include "Profiler.h"
+#include "Renderer.h"
+#include "Settings.h"
 #include GLHEADER
 #include <nanosvg/nanosvg.h>
 #include <nanosvg/nanosvgrast.h>
+#include <algorithm>
 #include <assert.h>
 #include <string.h>
 
 #define DPI 96
+#define THUMBNAIL_MAX_SCALE 0.75f // images are only scaled down if that saves a good part of their pixels
+
+// Works out the size an image shown at displayWidth x displayHeight is scaled down to, keeping its aspect ratio
+// and just covering the display size. Returns false if it isn't worth scaling.
+static bool getThumbnailSize(size_t width, size_t height, size_t displayWidth, size_t displayHeight, size_t& thumbnailWidth, size_t& thumbnailHeight)
+{
+	if (!width || !height)
+		return false;
+
+	float scale = 0.0f;
+	if (displayWidth)
+		scale = std::max(scale, (float)displayWidth / width);
+	if (displayHeight)
+		scale = std::max(scale, (float)displayHeight / height);
+
+	if ((scale == 0.0f) || (scale > THUMBNAIL_MAX_SCALE))
+		return false;
+
+	thumbnailWidth = std::max((size_t)1, (size_t)Math::round(width * scale));
+	thumbnailHeight = std::max((size_t)1, (size_t)Math::round(height * scale));
+	return true;
+}
+
+std::atomic<size_t> TextureData::sTotalVRAMUsage(0);
+std::atomic<size_t> TextureData::sTotalRAMUsage(0);
+std::atomic<size_t> TextureData::sTotalCommittedSize(0);
 
 TextureData::TextureData(bool tile) : mTile(tile), mTextureID(0), mDataRGBA(nullptr), mScalable(false),
-									  mWidth(0), mHeight(0), mSourceWidth(0.0f), mSourceHeight(0.0f)
+									  mWidth(0), mHeight(0), mSourceWidth(0.0f), mSourceHeight(0.0f),
+									  mDisplayWidth(0), mDisplayHeight(0), mCountedVRAM(0), mCountedRAM(0), mCountedCommitted(0)
 {
 }
 
@@ -86,6 +118,7 @@ bool TextureData::initSVGFromMemory(const unsigned char* fileData, size_t length
 
 	std::unique_lock<std::mutex> lock(mMutex);
 	mDataRGBA = dataRGBA;
+	updateMemoryUsage();
 
 	return true;
 }
@@ -112,6 +145,21 @@ bool TextureData::initImageFromMemory(const unsigned char* fileData, size_t leng
 	mSourceHeight = (float) height;
 	mScalable = false;
 
+	// Large images that are only shown small are scaled down once and kept in the thumbnail cache, resources
+	// that are built into the program aren't as they don't have a meaningful modification time
+	ThumbnailCache::Thumbnail thumbnail;
+	if (getThumbnailSize(width, height, mDisplayWidth, mDisplayHeight, thumbnail.width, thumbnail.height))
+	{
+		thumbnail.dataRGBA = ImageIO::scaleDownRGBA32(imageRGBA.data(), width, height, thumbnail.width, thumbnail.height);
+		thumbnail.sourceWidth = width;
+		thumbnail.sourceHeight = height;
+
+		if (!mPath.empty() && (mPath[0] != ':') && Settings::getInstance()->getBool("ThumbnailCache"))
+			ThumbnailCache::save(mPath, mDisplayWidth, mDisplayHeight, thumbnail);
+
+		return initFromRGBA(thumbnail.dataRGBA.data(), thumbnail.width, thumbnail.height);
+	}
+
 	return initFromRGBA(imageRGBA.data(), width, height);
 }
 
@@ -127,9 +175,48 @@ bool TextureData::initFromRGBA(const unsigned char* dataRGBA, size_t width, size
 	memcpy(mDataRGBA, dataRGBA, width * height * 4);
 	mWidth = width;
 	mHeight = height;
+	updateMemoryUsage();
 	return true;
 }
 
+void TextureData::updateFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height)
+{
+	Profiler::ScopedTimer timer("texture", "TextureData::updateFromRGBA");
+	std::unique_lock<std::mutex> lock(mMutex);
+	delete[] mDataRGBA;
+	mDataRGBA = nullptr;
+
+	if ((mTextureID != 0) && ((width != mWidth) || (height != mHeight)))
+	{
+		glDeleteTextures(1, &mTextureID);
+		mTextureID = 0;
+	}
+
+	if (mTextureID == 0)
+	{
+		glGenTextures(1, &mTextureID);
+		glBindTexture(GL_TEXTURE_2D, mTextureID);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)width, (GLsizei)height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		const GLint wrapMode = mTile ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+	}
+	else
+	{
+		glBindTexture(GL_TEXTURE_2D, mTextureID);
+	}
+
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei)width, (GLsizei)height, GL_RGBA, GL_UNSIGNED_BYTE, dataRGBA);
+	mWidth = width;
+	mHeight = height;
+	updateMemoryUsage();
+}
+
 bool TextureData::load()
 {
 	bool retval = false;
@@ -138,19 +225,43 @@ bool TextureData::load()
 	if (!mPath.empty())
 	{
 		std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
-		const ResourceData& data = rm->getFileData(mPath);
 		// is it an SVG?
 		if (mPath.substr(mPath.size() - 4, std::string::npos) == ".svg")
 		{
+			const ResourceData& data = rm->getFileData(mPath);
 			mScalable = true;
 			retval = initSVGFromMemory((const unsigned char*)data.ptr.get(), data.length);
 		}
+		else if (loadThumbnail())
+		{
+			// A cached thumbnail saves reading and decoding the full image
+			retval = true;
+		}
 		else
+		{
+			const ResourceData& data = rm->getFileData(mPath);
 			retval = initImageFromMemory((const unsigned char*)data.ptr.get(), data.length);
+		}
 	}
 	return retval;
 }
 
+bool TextureData::loadThumbnail()
+{
+	if ((!mDisplayWidth && !mDisplayHeight) || (mPath[0] == ':') || !Settings::getInstance()->getBool("ThumbnailCache"))
+		return false;
+
+	ThumbnailCache::Thumbnail thumbnail;
+	if (!ThumbnailCache::load(mPath, mDisplayWidth, mDisplayHeight, thumbnail))
+		return false;
+
+	mSourceWidth = (float)thumbnail.sourceWidth;
+	mSourceHeight = (float)thumbnail.sourceHeight;
+	mScalable = false;
+
+	return initFromRGBA(thumbnail.dataRGBA.data(), thumbnail.width, thumbnail.height);
+}
+
 bool TextureData::isLoaded()
 {
 	std::unique_lock<std::mutex> lock(mMutex);
@@ -159,7 +270,13 @@ bool TextureData::isLoaded()
 	return false;
 }
 
-bool TextureData::uploadAndBind()
+bool TextureData::isUploaded()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return mTextureID != 0;
+}
+
+bool TextureData::uploadAndBind(GLuint* textureId)
 {
 	// See if it's already been uploaded
 	std::unique_lock<std::mutex> lock(mMutex);
@@ -177,6 +294,7 @@ bool TextureData::uploadAndBind()
 		// Make sure we're ready to upload
 		if ((mWidth == 0) || (mHeight == 0) || (mDataRGBA == nullptr))
 			return false;
+		Profiler::ScopedTimer timer("texture", "TextureData::upload");
 		glGetError();
 		//now for the openGL texture stuff
 		glGenTextures(1, &mTextureID);
@@ -190,7 +308,10 @@ bool TextureData::uploadAndBind()
 		const GLint wrapMode = mTile ? GL_REPEAT : GL_CLAMP_TO_EDGE;
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+		updateMemoryUsage();
 	}
+	if (textureId != nullptr)
+		*textureId = mTextureID;
 	return true;
 }
 
@@ -199,8 +320,11 @@ void TextureData::releaseVRAM()
 	std::unique_lock<std::mutex> lock(mMutex);
 	if (mTextureID != 0)
 	{
+		// It may be in a batched draw that hasn't been flushed yet
+		Renderer::flush();
 		glDeleteTextures(1, &mTextureID);
 		mTextureID = 0;
+		updateMemoryUsage();
 	}
 }
 
@@ -209,6 +333,7 @@ void TextureData::releaseRAM()
 	std::unique_lock<std::mutex> lock(mMutex);
 	delete[] mDataRGBA;
 	mDataRGBA = 0;
+	updateMemoryUsage();
 }
 
 size_t TextureData::width()
@@ -253,6 +378,40 @@ void TextureData::setSourceSize(float width, float height)
 	}
 }
 
+void TextureData::setDisplaySize(size_t width, size_t height)
+{
+	mDisplayWidth = width;
+	mDisplayHeight = height;
+}
+
+bool TextureData::isScaledDown(size_t width, size_t height, size_t displayWidth, size_t displayHeight)
+{
+	size_t thumbnailWidth, thumbnailHeight;
+	return getThumbnailSize(width, height, displayWidth, displayHeight, thumbnailWidth, thumbnailHeight);
+}
+
+size_t TextureData::getKnownSize()
+{
+	return mWidth * mHeight * 4;
+}
+
+void TextureData::updateMemoryUsage()
+{
+	// Apply the difference to what was counted for this texture before, so the totals never need a full walk
+	const size_t size = mWidth * mHeight * 4;
+	const size_t vram = (mTextureID != 0) ? size : 0;
+	const size_t ram = (mDataRGBA != nullptr) ? size : 0;
+	const size_t committed = ((mTextureID != 0) || (mDataRGBA != nullptr)) ? size : 0;
+
+	sTotalVRAMUsage += vram - mCountedVRAM;
+	sTotalRAMUsage += ram - mCountedRAM;
+	sTotalCommittedSize += committed - mCountedCommitted;
+
+	mCountedVRAM = vram;
+	mCountedRAM = ram;
+	mCountedCommitted = committed;
+}
+
 size_t TextureData::getVRAMUsage()
 {
 	if ((mTextureID != 0) || (mDataRGBA != nullptr))
@@ -4,6 +4,7 @@
 
 #include "platform.h"
 #include GLHEADER
+#include <atomic>
 #include <mutex>
 #include <string>
 
@@ -23,14 +24,19 @@ public:
 	bool initImageFromMemory(const unsigned char* fileData, size_t length);
 	bool initFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height);
 
+	// Writes the pixels straight into the texture in VRAM, only (re)creating it when the size changes.
+	// Meant for textures that change every frame, no copy is kept in RAM.
+	void updateFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height);
+
 	// Read the data into memory if necessary
 	bool load();
 
 	bool isLoaded();
+	bool isUploaded(); // in VRAM, isLoaded() is also true if it's only decoded in RAM
 
 	// Upload the texture to VRAM if necessary and bind. Returns true if bound ok or
 	// false if either not loaded
-	bool uploadAndBind();
+	bool uploadAndBind(GLuint* textureId = nullptr); // textureId is set to the bound texture
 
 	// Release the texture from VRAM
 	void releaseVRAM();
@@ -40,16 +46,30 @@ public:
 
 	// Get the amount of VRAM currenty used by this texture
 	size_t getVRAMUsage();
+	// The amount of memory this texture takes once loaded, 0 if it hasn't been loaded yet (unlike width(), this never loads it)
+	size_t getKnownSize();
+
+	// Running totals over every texture, kept up to date as they're loaded, uploaded and released
+	static size_t getTotalVRAMUsage() { return sTotalVRAMUsage; } // uploaded to VRAM
+	static size_t getTotalRAMUsage() { return sTotalRAMUsage; } // decoded pixels kept in RAM
+	static size_t getTotalCommittedSize() { return sTotalCommittedSize; } // in VRAM, RAM or both, counted once
 
 	size_t width();
 	size_t height();
 	float sourceWidth();
 	float sourceHeight();
 	void setSourceSize(float width, float height);
+	// Images much larger than this are scaled down, and kept in the thumbnail cache, when they're loaded
+	void setDisplaySize(size_t width, size_t height);
+	// Whether an image of this size is scaled down when it's shown at the display size
+	static bool isScaledDown(size_t width, size_t height, size_t displayWidth, size_t displayHeight);
 
 	bool tiled() { return mTile; }
 
 private:
+	bool loadThumbnail();
+	void updateMemoryUsage(); // must be called with mMutex held after the data or texture changes
+
 	std::mutex		mMutex;
 	bool			mTile;
 	std::string		mPath;
@@ -59,8 +79,18 @@ private:
 	size_t			mHeight;
 	float			mSourceWidth;
 	float			mSourceHeight;
+	size_t			mDisplayWidth;
+	size_t			mDisplayHeight;
 	bool			mScalable;
 	bool			mReloadable;
+
+	size_t			mCountedVRAM;
+	size_t			mCountedRAM;
+	size_t			mCountedCommitted;
+
+	static std::atomic<size_t>	sTotalVRAMUsage;
+	static std::atomic<size_t>	sTotalRAMUsage;
+	static std::atomic<size_t>	sTotalCommittedSize;
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_DATA_H
@@ -2,7 +2,10 @@
 
 #include "resources/TextureData.h"
 #include "resources/TextureResource.h"
+#include "utils/ThreadPool.h"
+#include "Profiler.h"
 #include "Settings.h"
+#include <algorithm>
 
 TextureDataManager::TextureDataManager()
 {
@@ -17,6 +20,8 @@ TextureDataManager::TextureDataManager()
 	}
 	mBlank->initFromRGBA(data, 5, 5);
 	mLoader = new TextureLoader;
+	mVRAMTier.stats = { 0, 0 };
+	mRAMTier.stats = { 0, 0 };
 }
 
 TextureDataManager::~TextureDataManager()
@@ -39,6 +44,11 @@ void TextureDataManager::remove(const TextureResource* key)
 	auto it = mTextureLookup.find(key);
 	if (it != mTextureLookup.cend())
 	{
+		// Drop it from the cache tiers
+		const TextureData* tex = (*(*it).second).get();
+		mVRAMTier.remove(tex);
+		mRAMTier.remove(tex);
+		mEvictedFromVRAM.erase(tex);
 		// Remove the list entry
 		mTextures.erase((*it).second);
 		// And the lookup
@@ -46,7 +56,7 @@ void TextureDataManager::remove(const TextureResource* key)
 	}
 }
 
-std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key)
+std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key, TextureLoadPriority priority)
 {
 	// If it's in the cache then we want to remove it from it's current location and
 	// move it to the top
@@ -63,19 +73,39 @@ std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key)
 		mTextureLookup[key] = mTextures.cbegin();
 
 		// Make sure it's loaded or queued for loading
-		load(tex);
+		load(tex, false, priority);
 	}
 	return tex;
 }
 
-bool TextureDataManager::bind(const TextureResource* key)
+bool TextureDataManager::bind(const TextureResource* key, GLuint* textureId)
 {
 	std::shared_ptr<TextureData> tex = get(key);
 	bool bound = false;
 	if (tex != nullptr)
-		bound = tex->uploadAndBind();
+	{
+		if (tex->isUploaded())
+		{
+			mVRAMTier.stats.hits++;
+		}
+		else if (tex->isLoaded())
+		{
+			// It's decoded in RAM and about to be uploaded, make room for it in VRAM
+			size_t max_vram = (size_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
+			evict(mVRAMTier, &TextureData::getTotalVRAMUsage, tex->getKnownSize(), max_vram, tex.get(), true);
+			mVRAMTier.stats.misses++;
+
+			// If it was in VRAM before, keeping it in RAM just saved a decode
+			if (mEvictedFromVRAM.erase(tex.get()))
+				mRAMTier.stats.hits++;
+		}
+
+		bound = tex->uploadAndBind(textureId);
+		if (bound)
+			mVRAMTier.touch(tex);
+	}
 	if (!bound)
-		mBlank->uploadAndBind();
+		mBlank->uploadAndBind(textureId);
 	return bound;
 }
 
@@ -83,15 +113,7 @@ size_t TextureDataManager::getTotalSize()
 {
 	size_t total = 0;
 	for (auto tex : mTextures)
-		total += tex->width() * tex->height() * 4;
-	return total;
-}
-
-size_t TextureDataManager::getCommittedSize()
-{
-	size_t total = 0;
-	for (auto tex : mTextures)
-		total += tex->getVRAMUsage();
+		total += tex->getKnownSize();
 	return total;
 }
 
@@ -100,114 +122,269 @@ size_t TextureDataManager::getQueueSize()
 	return mLoader->getQueueSize();
 }
 
-void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
+void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block, TextureLoadPriority priority)
 {
-	// See if it's already loaded
+	// See if it's already loaded, uploading it is up to bind()
 	if (tex->isLoaded())
 		return;
-	// Not loaded. Make sure there is room
-	size_t size = TextureResource::getTotalMemUsage();
-	size_t max_texture = (size_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
-
-	for (auto it = mTextures.crbegin(); it != mTextures.crend(); ++it)
-	{
-		if (size < max_texture)
-			break;
-		//size -= (*it)->getVRAMUsage();
-		(*it)->releaseVRAM();
-		(*it)->releaseRAM();
-		// It may be already in the loader queue. In this case it wouldn't have been using
-		// any VRAM yet but it will be. Remove it from the loader queue
-		mLoader->remove(*it);
-		size = TextureResource::getTotalMemUsage();
-	}
+	// Not loaded. Make sure there is room in RAM to decode it into, counting what the loader queue is
+	// about to decode as well. The usage is kept as running totals so checking it is cheap
+	size_t max_ram = (size_t)Settings::getInstance()->getInt("MaxTextureRAM") * 1024 * 1024;
+	TextureLoader* loader = mLoader;
+	evict(mRAMTier, [loader] { return TextureData::getTotalRAMUsage() + loader->getQueueSize(); }, tex->getKnownSize(), max_ram, tex.get(), false);
+
+	mRAMTier.touch(tex);
 	if (!block)
-		mLoader->load(tex);
+	{
+		if (mLoader->load(tex, priority))
+			mRAMTier.stats.misses++;
+	}
 	else
-		tex->load();
+	{
+		// Not by calling tex->load() directly, it may be queued or being decoded by a worker already
+		if (mLoader->loadNow(tex))
+			mRAMTier.stats.misses++;
+	}
 }
 
-TextureLoader::TextureLoader() : mExit(false)
+void TextureDataManager::evict(CacheTier& tier, const std::function<size_t()>& used, size_t needed, size_t budget, const TextureData* keep, bool vram)
 {
-	mThread = new std::thread(&TextureLoader::threadProc, this);
+	// A budget of 0 means there's no limit
+	if (budget == 0)
+		return;
+
+	auto it = tier.textures.end();
+	while ((used() + needed > budget) && (it != tier.textures.begin()))
+	{
+		--it;
+		std::shared_ptr<TextureData> tex = *it;
+		if (tex.get() == keep)
+			continue;
+
+		if (vram)
+		{
+			// Its pixels stay decoded in RAM (if they still are) so it only needs uploading again
+			tex->releaseVRAM();
+			if (tex->isLoaded())
+				mEvictedFromVRAM.insert(tex.get());
+		}
+		else
+		{
+			// It may be already in the loader queue. In this case it wouldn't have been using
+			// any RAM yet but it will be. Remove it from the loader queue
+			tex->releaseRAM();
+			mLoader->remove(tex);
+			mEvictedFromVRAM.erase(tex.get());
+		}
+
+		tier.lookup.erase(tex.get());
+		it = tier.textures.erase(it);
+	}
+}
+
+void TextureDataManager::CacheTier::touch(const std::shared_ptr<TextureData>& tex)
+{
+	// Move it to the front, or add it there if it isn't in the tier yet
+	auto it = lookup.find(tex.get());
+	if (it != lookup.cend())
+	{
+		textures.splice(textures.begin(), textures, (*it).second);
+	}
+	else
+	{
+		textures.push_front(tex);
+		lookup[tex.get()] = textures.begin();
+	}
+}
+
+void TextureDataManager::CacheTier::remove(const TextureData* tex)
+{
+	auto it = lookup.find(tex);
+	if (it != lookup.cend())
+	{
+		textures.erase((*it).second);
+		lookup.erase(it);
+	}
+}
+
+TextureLoader::TextureLoader() : mQueueSize(0), mExit(false)
+{
+	// the workers are only started on the first load, as the settings aren't available yet when the
+	// static texture data manager is constructed
 }
 
 TextureLoader::~TextureLoader()
 {
 	// Just abort any waiting texture
-	mTextureDataQ.clear();
-	mTextureDataLookup.clear();
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		for (int i = 0; i < TEXTURE_LOAD_PRIORITY_COUNT; ++i)
+			mTextureDataQ[i].clear();
+		mTextureDataLookup.clear();
+		mQueueSize = 0;
+		mExit = true;
+	}
 
-	// Exit the thread
-	mExit = true;
-	mEvent.notify_one();
-	mThread->join();
-	delete mThread;
+	// Exit the threads
+	mEvent.notify_all();
+	for (auto it = mThreads.cbegin(); it != mThreads.cend(); ++it)
+	{
+		(*it)->join();
+		delete *it;
+	}
+}
+
+void TextureLoader::startThreads()
+{
+	// 0 means one worker per core, minus the one the renderer runs on
+	int threadCount = Settings::getInstance()->getInt("TextureLoaderThreads");
+	if (threadCount <= 0)
+		threadCount = std::max(1, Utils::ThreadPool::getHardwareThreadCount() - 1);
+
+	for (int i = 0; i < threadCount; ++i)
+		mThreads.push_back(new std::thread(&TextureLoader::threadProc, this));
 }
 
 void TextureLoader::threadProc()
 {
-	while (!mExit)
+	while (true)
 	{
 		std::shared_ptr<TextureData> textureData;
 		{
 			// Wait for an event to say there is something in the queue
 			std::unique_lock<std::mutex> lock(mMutex);
-			mEvent.wait(lock);
-			if (!mTextureDataQ.empty())
+			mEvent.wait(lock, [this] { return mExit || !mTextureDataLookup.empty(); });
+			if (mExit)
+				return;
+
+			// Take the newest request from the most important lane
+			for (int i = 0; i < TEXTURE_LOAD_PRIORITY_COUNT; ++i)
 			{
-				textureData = mTextureDataQ.front();
-				mTextureDataQ.pop_front();
-				mTextureDataLookup.erase(mTextureDataLookup.find(textureData.get()));
+				if (!mTextureDataQ[i].empty())
+				{
+					textureData = mTextureDataQ[i].front();
+					mTextureDataQ[i].pop_front();
+					auto td = mTextureDataLookup.find(textureData.get());
+					mQueueSize -= (*td).second.size;
+					mTextureDataLookup.erase(td);
+					mTextureDataLoading[textureData.get()] = false;
+					break;
+				}
 			}
 		}
-		// Queue has been released here but we might have a texture to process
-		while (textureData)
+
 		{
+			Profiler::ScopedTimer timer("texture", "TextureLoader::decode");
 			textureData->load();
+		}
 
-			// See if there is another item in the queue
-			textureData = nullptr;
+		bool removed;
+		{
 			std::unique_lock<std::mutex> lock(mMutex);
-			if (!mTextureDataQ.empty())
-			{
-				textureData = mTextureDataQ.front();
-				mTextureDataQ.pop_front();
-				mTextureDataLookup.erase(mTextureDataLookup.find(textureData.get()));
-			}
+			auto loading = mTextureDataLoading.find(textureData.get());
+			removed = (*loading).second;
+			mTextureDataLoading.erase(loading);
 		}
+		mLoadDone.notify_all();
+
+		// It was removed while it was loading, so drop what was just loaded
+		if (removed)
+			textureData->releaseRAM();
 	}
 }
 
-void TextureLoader::load(std::shared_ptr<TextureData> textureData)
+bool TextureLoader::load(std::shared_ptr<TextureData> textureData, TextureLoadPriority priority)
 {
 	// Make sure it's not already loaded
 	if (!textureData->isLoaded())
 	{
 		std::unique_lock<std::mutex> lock(mMutex);
-		// Remove it from the queue if it is already there
+
+		if (mThreads.empty())
+			startThreads();
+
+		// A worker has it already, make sure a pending removal doesn't throw it away
+		auto loading = mTextureDataLoading.find(textureData.get());
+		if (loading != mTextureDataLoading.cend())
+		{
+			(*loading).second = false;
+			return false;
+		}
+
+		// Remove it from the queue if it is already there, it keeps the more important of both lanes
+		bool queued = false;
 		auto td = mTextureDataLookup.find(textureData.get());
 		if (td != mTextureDataLookup.cend())
 		{
-			mTextureDataQ.erase((*td).second);
+			queued = true;
+			priority = std::min(priority, (*td).second.priority);
+			mTextureDataQ[(*td).second.priority].erase((*td).second.iterator);
+			mQueueSize -= (*td).second.size;
 			mTextureDataLookup.erase(td);
 		}
 
-		// Put it on the start of the queue as we want the newly requested textures to load first
-		mTextureDataQ.push_front(textureData);
-		mTextureDataLookup[textureData.get()] = mTextureDataQ.cbegin();
+		// Put it on the start of the queue as we want the newly requested textures to load first.
+		// Textures that were never loaded don't know their size yet, they're counted once they are.
+		mTextureDataQ[priority].push_front(textureData);
+		QueueEntry entry = { priority, mTextureDataQ[priority].cbegin(), textureData->getKnownSize() };
+		mQueueSize += entry.size;
+		mTextureDataLookup[textureData.get()] = entry;
 		mEvent.notify_one();
+		return !queued;
 	}
+	return false;
 }
 
 void TextureLoader::remove(std::shared_ptr<TextureData> textureData)
 {
 	// Just remove it from the queue so we don't attempt to load it
 	std::unique_lock<std::mutex> lock(mMutex);
-	auto td = mTextureDataLookup.find(textureData.get());
+	dequeue(textureData.get());
+
+	// If a worker is loading it right now, the data is released again once it's done
+	auto loading = mTextureDataLoading.find(textureData.get());
+	if (loading != mTextureDataLoading.cend())
+		(*loading).second = true;
+}
+
+bool TextureLoader::loadNow(std::shared_ptr<TextureData> textureData)
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		// A worker would only decode it a second time
+		dequeue(textureData.get());
+
+		// A worker has it already, wait for it rather than decoding the same image twice
+		auto loading = mTextureDataLoading.find(textureData.get());
+		if (loading != mTextureDataLoading.cend())
+		{
+			(*loading).second = false;
+			TextureData* data = textureData.get();
+			mLoadDone.wait(lock, [this, data] { return mTextureDataLoading.find(data) == mTextureDataLoading.cend(); });
+		}
+	}
+
+	if (textureData->isLoaded())
+		return false;
+
+	textureData->load();
+	return true;
+}
+
+void TextureLoader::wait()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mLoadDone.wait(lock, [this] { return mTextureDataLookup.empty() && mTextureDataLoading.empty(); });
+}
+
+void TextureLoader::dequeue(TextureData* textureData)
+{
+	auto td = mTextureDataLookup.find(textureData);
 	if (td != mTextureDataLookup.cend())
 	{
-		mTextureDataQ.erase((*td).second);
+		mTextureDataQ[(*td).second.priority].erase((*td).second.iterator);
+		mQueueSize -= (*td).second.size;
 		mTextureDataLookup.erase(td);
 	}
 }
@@ -216,11 +393,6 @@ size_t TextureLoader::getQueueSize()
 {
 	// Gets the amount of video memory that will be used once all textures in
 	// the queue are loaded
-	size_t mem = 0;
 	std::unique_lock<std::mutex> lock(mMutex);
-	for (auto tex : mTextureDataQ)
-	{
-		mem += tex->width() * tex->height() * 4;
-	}
-	return mem;
+	return mQueueSize;
 }
@@ -2,37 +2,71 @@
 #ifndef ES_CORE_RESOURCES_TEXTURE_DATA_MANAGER_H
 #define ES_CORE_RESOURCES_TEXTURE_DATA_MANAGER_H
 
+#include "platform.h"
+#include GLHEADER
 #include <condition_variable>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <thread>
+#include <vector>
 
 class TextureData;
 class TextureResource;
 
+// The loader's queues, a lane is only worked on once every lane above it is empty
+enum TextureLoadPriority
+{
+	TEXTURE_LOAD_VISIBLE,    // needed to draw what's on screen right now
+	TEXTURE_LOAD_PREFETCH,   // likely to be on screen soon
+	TEXTURE_LOAD_BACKGROUND, // nice to have, i.e. the screensaver
+
+	TEXTURE_LOAD_PRIORITY_COUNT
+};
+
 class TextureLoader
 {
 public:
 	TextureLoader();
 	~TextureLoader();
 
-	void load(std::shared_ptr<TextureData> textureData);
+	// Returns false if it was already queued or being loaded
+	bool load(std::shared_ptr<TextureData> textureData, TextureLoadPriority priority = TEXTURE_LOAD_VISIBLE);
 	void remove(std::shared_ptr<TextureData> textureData);
+	// Loads it on the calling thread, unless a worker is loading it already, then it waits for that one.
+	// Returns false if it didn't have to be decoded again
+	bool loadNow(std::shared_ptr<TextureData> textureData);
+	// Blocks until the queue is empty and no worker is loading anything
+	void wait();
 
 	size_t getQueueSize();
 
 private:
-	void processQueue();
+	typedef std::list<std::shared_ptr<TextureData> > TextureDataList;
+
+	struct QueueEntry
+	{
+		TextureLoadPriority priority;
+		TextureDataList::const_iterator iterator;
+		size_t size; // what was added to mQueueSize for it
+	};
+
+	void startThreads();
 	void threadProc();
+	void dequeue(TextureData* textureData); // must be called with mMutex held
 
-	std::list<std::shared_ptr<TextureData> > 										mTextureDataQ;
-	std::map<TextureData*, std::list<std::shared_ptr<TextureData> >::const_iterator > 	mTextureDataLookup;
+	TextureDataList										mTextureDataQ[TEXTURE_LOAD_PRIORITY_COUNT];
+	std::map<TextureData*, QueueEntry>					mTextureDataLookup;
+	std::map<TextureData*, bool>						mTextureDataLoading; // being loaded by a worker, true if removed meanwhile
+	size_t												mQueueSize;
 
-	std::thread*				mThread;
+	std::vector<std::thread*>	mThreads;
 	std::mutex					mMutex;
 	std::condition_variable		mEvent;
+	std::condition_variable		mLoadDone; // a worker finished loading a texture
 	bool 						mExit;
 };
 
@@ -45,14 +79,23 @@ private:
 // at this point the texture data is loaded (via a call to load()).
 //
 // Once the load is complete (which may not be on the first call to get() if the
-// data is loaded in a background thread) then the get() function call uploadAndBind()
-// to upload to VRAM if necessary and bind the texture. This is followed by a call
-// to releaseRAM() which frees the memory buffer if the texture can be reloaded from
-// disk if needed again
+// data is loaded in a background thread) then the bind() function calls uploadAndBind()
+// to upload to VRAM if necessary and bind the texture.
+//
+// Decoded pixels in RAM and uploaded textures in VRAM are two tiers of cache, each with
+// its own budget (MaxTextureRAM and MaxVRAM) and least recently used list. A texture
+// that's dropped from VRAM but still in RAM only needs uploading again, not decoding.
 //
 class TextureDataManager
 {
 public:
+	// Hits and misses of one tier, see getVRAMStats() and getRAMStats()
+	struct TierStats
+	{
+		unsigned int hits;
+		unsigned int misses;
+	};
+
 	TextureDataManager();
 	~TextureDataManager();
 
@@ -63,20 +106,45 @@ public:
 	// will be deleted when the other thread has finished with it
 	void remove(const TextureResource* key);
 
-	std::shared_ptr<TextureData> get(const TextureResource* key);
-	bool bind(const TextureResource* key);
+	std::shared_ptr<TextureData> get(const TextureResource* key, TextureLoadPriority priority = TEXTURE_LOAD_VISIBLE);
+	bool bind(const TextureResource* key, GLuint* textureId = nullptr); // textureId is set to the bound texture, the blank one if it isn't loaded
 
 	// Get the total size of all textures managed by this object, loaded and unloaded in bytes
 	size_t	getTotalSize();
-	// Get the total size of all committed textures (in VRAM) in bytes
-	size_t	getCommittedSize();
 	// Get the total size of all load-pending textures in the queue - these will
 	// be committed to VRAM as the queue is processed
 	size_t  getQueueSize();
 	// Load a texture, freeing resources as necessary to make space
-	void load(std::shared_ptr<TextureData> tex, bool block = false);
+	void load(std::shared_ptr<TextureData> tex, bool block = false, TextureLoadPriority priority = TEXTURE_LOAD_VISIBLE);
+	// Blocks until every texture that was queued for loading is loaded
+	void waitForLoads() { mLoader->wait(); }
+
+	// VRAM hits are binds of an uploaded texture, misses are uploads
+	const TierStats& getVRAMStats() const { return mVRAMTier.stats; }
+	// RAM hits are uploads of pixels that were still decoded, misses are decodes
+	const TierStats& getRAMStats() const { return mRAMTier.stats; }
 
 private:
+	// The textures holding memory in one tier, most recently used first. Textures that released
+	// their memory some other way are only dropped from it when eviction gets to them.
+	struct CacheTier
+	{
+		typedef std::list<std::shared_ptr<TextureData> > TextureDataList;
+
+		TextureDataList									textures;
+		std::map<const TextureData*, TextureDataList::iterator>	lookup;
+		TierStats										stats;
+
+		void touch(const std::shared_ptr<TextureData>& tex);
+		void remove(const TextureData* tex);
+	};
+
+	// Releases the least recently used memory of tier, besides that of keep, until used() + needed fits in budget bytes
+	void evict(CacheTier& tier, const std::function<size_t()>& used, size_t needed, size_t budget, const TextureData* keep, bool vram);
+
+	CacheTier																				mVRAMTier;
+	CacheTier																				mRAMTier;
+	std::set<const TextureData*>															mEvictedFromVRAM; // still decoded in RAM
 
 	std::list<std::shared_ptr<TextureData> >												mTextures;
 	std::map<const TextureResource*, std::list<std::shared_ptr<TextureData> >::const_iterator > 	mTextureLookup;
@@ -6,8 +6,11 @@
 TextureDataManager		TextureResource::sTextureDataManager;
 std::map< TextureResource::TextureKeyType, std::weak_ptr<TextureResource> > TextureResource::sTextureMap;
 std::set<TextureResource*> 	TextureResource::sAllTextures;
+TextureResource::PrefetchStats	TextureResource::sPrefetchStats = { 0, 0, 0, 0 };
+std::map<std::string, Vector2i>	TextureResource::sSourceSizes;
 
-TextureResource::TextureResource(const std::string& path, bool tile, bool dynamic) : mTextureData(nullptr), mForceLoad(false)
+TextureResource::TextureResource(const std::string& path, bool tile, bool dynamic, const Vector2i& displaySize, bool prefetch, TextureLoadPriority prefetchPriority) : mTextureData(nullptr), mForceLoad(false),
+	mPrefetched(prefetch && dynamic)
 {
 	// Create a texture data object for this texture
 	if (!path.empty())
@@ -19,20 +22,33 @@ TextureResource::TextureResource(const std::string& path, bool tile, bool dynami
 		{
 			data = sTextureDataManager.add(this, tile);
 			data->initFromPath(path);
-			// Force the texture manager to load it using a blocking load
-			sTextureDataManager.load(data, true);
+			data->setDisplaySize(displaySize.x(), displaySize.y());
+			if (mPrefetched)
+			{
+				// Let the loader decode it in the background, the size is read once get() hands it out
+				sTextureDataManager.load(data, false, prefetchPriority);
+			}
+			else
+			{
+				// Force the texture manager to load it using a blocking load
+				sTextureDataManager.load(data, true);
+			}
 		}
 		else
 		{
 			mTextureData = std::shared_ptr<TextureData>(new TextureData(tile));
 			data = mTextureData;
 			data->initFromPath(path);
+			data->setDisplaySize(displaySize.x(), displaySize.y());
 			// Load it so we can read the width/height
 			data->load();
 		}
 
-		mSize = Vector2i((int)data->width(), (int)data->height());
-		mSourceSize = Vector2f(data->sourceWidth(), data->sourceHeight());
+		if (!mPrefetched)
+		{
+			mSize = Vector2i((int)data->width(), (int)data->height());
+			mSourceSize = Vector2f(data->sourceWidth(), data->sourceHeight());
+		}
 	}
 	else
 	{
@@ -44,6 +60,9 @@ TextureResource::TextureResource(const std::string& path, bool tile, bool dynami
 
 TextureResource::~TextureResource()
 {
+	if (mPrefetched)
+		sPrefetchStats.unused++;
+
 	if (mTextureData == nullptr)
 		sTextureDataManager.remove(this);
 
@@ -62,6 +81,15 @@ void TextureResource::initFromPixels(const unsigned char* dataRGBA, size_t width
 	mSourceSize = Vector2f(mTextureData->sourceWidth(), mTextureData->sourceHeight());
 }
 
+void TextureResource::updateFromPixels(const unsigned char* dataRGBA, size_t width, size_t height)
+{
+	// This is only valid if we have a local texture data object
+	assert(mTextureData != nullptr);
+	mTextureData->updateFromRGBA(dataRGBA, width, height);
+	mSize = Vector2i((int)width, (int)height);
+	mSourceSize = Vector2f((float)width, (float)height);
+}
+
 void TextureResource::initFromMemory(const char* data, size_t length)
 {
 	// This is only valid if we have a local texture data object
@@ -87,20 +115,20 @@ bool TextureResource::isTiled() const
 	return data->tiled();
 }
 
-bool TextureResource::bind()
+bool TextureResource::bind(GLuint* textureId)
 {
 	if (mTextureData != nullptr)
 	{
-		mTextureData->uploadAndBind();
+		mTextureData->uploadAndBind(textureId);
 		return true;
 	}
 	else
 	{
-		return sTextureDataManager.bind(this);
+		return sTextureDataManager.bind(this, textureId);
 	}
 }
 
-std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, bool tile, bool forceLoad, bool dynamic)
+std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, bool tile, bool forceLoad, bool dynamic, const Vector2i& displaySize)
 {
 	std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
 
@@ -112,24 +140,35 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 		return tex;
 	}
 
-	TextureKeyType key(canonicalPath, tile);
+	const Vector2i textureDisplaySize = getTextureDisplaySize(canonicalPath, tile, displaySize);
+	TextureKeyType key(canonicalPath, tile, textureDisplaySize.x(), textureDisplaySize.y());
 	auto foundTexture = sTextureMap.find(key);
 	if(foundTexture != sTextureMap.cend())
 	{
 		if(!foundTexture->second.expired())
-			return foundTexture->second.lock();
+		{
+			std::shared_ptr<TextureResource> tex = foundTexture->second.lock();
+			if(tex->mPrefetched)
+			{
+				tex->claimPrefetched();
+				addSourceSize(tex, canonicalPath, tile);
+			}
+			return tex;
+		}
 	}
 
 	// need to create it
 	std::shared_ptr<TextureResource> tex;
-	tex = std::shared_ptr<TextureResource>(new TextureResource(key.first, tile, dynamic));
+	tex = std::shared_ptr<TextureResource>(new TextureResource(canonicalPath, tile, dynamic, textureDisplaySize));
 	std::shared_ptr<TextureData> data = sTextureDataManager.get(tex.get());
 
 	// is it an SVG?
-	if(key.first.substr(key.first.size() - 4, std::string::npos) != ".svg")
+	if(canonicalPath.substr(canonicalPath.size() - 4, std::string::npos) != ".svg")
 	{
 		// Probably not. Add it to our map. We don't add SVGs because 2 svgs might be rasterized at different sizes
 		sTextureMap[key] = std::weak_ptr<TextureResource>(tex);
+		if(dynamic)
+			addSourceSize(tex, canonicalPath, tile);
 	}
 
 	// Add it to the reloadable list
@@ -145,6 +184,86 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 	return tex;
 }
 
+std::shared_ptr<TextureResource> TextureResource::prefetch(const std::string& path, bool tile, const Vector2i& displaySize, TextureLoadPriority priority)
+{
+	// SVGs are rasterized at the size they are shown at, so there's nothing to prepare for them
+	const std::string canonicalPath = Utils::FileSystem::getCanonicalPath(path);
+	if(canonicalPath.empty() || canonicalPath.substr(canonicalPath.size() - 4, std::string::npos) == ".svg")
+		return nullptr;
+
+	const Vector2i textureDisplaySize = getTextureDisplaySize(canonicalPath, tile, displaySize);
+	TextureKeyType key(canonicalPath, tile, textureDisplaySize.x(), textureDisplaySize.y());
+	auto foundTexture = sTextureMap.find(key);
+	if(foundTexture != sTextureMap.cend())
+	{
+		if(!foundTexture->second.expired())
+			return foundTexture->second.lock();
+	}
+
+	std::shared_ptr<TextureResource> tex = std::shared_ptr<TextureResource>(new TextureResource(canonicalPath, tile, true, textureDisplaySize, true, priority));
+	sTextureMap[key] = std::weak_ptr<TextureResource>(tex);
+	ResourceManager::getInstance()->addReloadable(tex);
+	sPrefetchStats.requested++;
+
+	return tex;
+}
+
+void TextureResource::claimPrefetched()
+{
+	// Moves it to the front of the visible lane if it's still waiting to be loaded
+	std::shared_ptr<TextureData> data = sTextureDataManager.get(this);
+	if (data->isLoaded())
+	{
+		sPrefetchStats.hits++;
+	}
+	else
+	{
+		// Not decoded (anymore), load it now just like a texture that was never prefetched
+		sPrefetchStats.late++;
+		sTextureDataManager.load(data, true);
+	}
+
+	mSize = Vector2i((int)data->width(), (int)data->height());
+	mSourceSize = Vector2f(data->sourceWidth(), data->sourceHeight());
+	mPrefetched = false;
+}
+
+Vector2i TextureResource::getTextureDisplaySize(const std::string& path, bool tile, const Vector2i& displaySize)
+{
+	// tiled textures are repeated rather than scaled, so they're always kept at full size
+	if(tile || (displaySize == Vector2i::Zero()))
+		return Vector2i::Zero();
+
+	// not known until it was loaded once, until then it may be scaled down
+	auto it = sSourceSizes.find(path);
+	if(it == sSourceSizes.cend())
+		return displaySize;
+
+	const Vector2i& sourceSize = it->second;
+	if(TextureData::isScaledDown((size_t)sourceSize.x(), (size_t)sourceSize.y(), (size_t)displaySize.x(), (size_t)displaySize.y()))
+		return displaySize;
+
+	return Vector2i::Zero();
+}
+
+void TextureResource::addSourceSize(const std::shared_ptr<TextureResource>& tex, const std::string& path, bool tile)
+{
+	const Vector2i sourceSize((int)tex->mSourceSize.x(), (int)tex->mSourceSize.y());
+	if(tile || (sourceSize.x() <= 0) || (sourceSize.y() <= 0))
+		return;
+
+	sSourceSizes[path] = sourceSize;
+
+	// the texture was loaded at full size, so it's the one every size that isn't scaled down shares
+	if((tex->mSize.x() == sourceSize.x()) && (tex->mSize.y() == sourceSize.y()))
+	{
+		TextureKeyType key(path, tile, 0, 0);
+		auto foundTexture = sTextureMap.find(key);
+		if((foundTexture == sTextureMap.cend()) || foundTexture->second.expired())
+			sTextureMap[key] = std::weak_ptr<TextureResource>(tex);
+	}
+}
+
 // For scalable source images in textures we want to set the resolution to rasterize at
 void TextureResource::rasterizeAt(size_t width, size_t height)
 {
@@ -169,20 +288,22 @@ bool TextureResource::isInitialized() const
 	return true;
 }
 
+bool TextureResource::isLoaded() const
+{
+	if (mTextureData != nullptr)
+		return mTextureData->isLoaded();
+	return sTextureDataManager.get(this)->isLoaded();
+}
+
 size_t TextureResource::getTotalMemUsage()
 {
-	size_t total = 0;
-	// Count up all textures that manage their own texture data
-	for (auto tex : sAllTextures)
-	{
-		if (tex->mTextureData != nullptr)
-			total += tex->mTextureData->getVRAMUsage();
-	}
-	// Now get the committed memory from the manager
-	total += sTextureDataManager.getCommittedSize();
-	// And the size of the loading queue
-	total += sTextureDataManager.getQueueSize();
-	return total;
+	// Every texture's committed memory is kept as a running total, add the size of the loading queue to it
+	return TextureData::getTotalCommittedSize() + sTextureDataManager.getQueueSize();
+}
+
+size_t TextureResource::getQueuedMemUsage()
+{
+	return sTextureDataManager.getQueueSize();
 }
 
 size_t TextureResource::getTotalTextureSize()
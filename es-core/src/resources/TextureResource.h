@@ -8,6 +8,7 @@
 #include "resources/TextureDataManager.h"
 #include <set>
 #include <string>
+#include <tuple>
 
 class TextureData;
 
@@ -16,8 +17,14 @@ class TextureData;
 class TextureResource : public IReloadable
 {
 public:
-	static std::shared_ptr<TextureResource> get(const std::string& path, bool tile = false, bool forceLoad = false, bool dynamic = true);
+	// If displaySize is set, images much larger than it are scaled down to just cover it (either side may be 0 to ignore it)
+	static std::shared_ptr<TextureResource> get(const std::string& path, bool tile = false, bool forceLoad = false, bool dynamic = true, const Vector2i& displaySize = Vector2i::Zero());
+	// Queues the texture to be decoded in the background so a later get() of the same path doesn't have to wait for it.
+	// It's only kept around while the returned pointer is held, returns nullptr for textures that can't be prefetched.
+	static std::shared_ptr<TextureResource> prefetch(const std::string& path, bool tile = false, const Vector2i& displaySize = Vector2i::Zero(), TextureLoadPriority priority = TEXTURE_LOAD_PREFETCH);
 	void initFromPixels(const unsigned char* dataRGBA, size_t width, size_t height);
+	// Like initFromPixels, but writes straight into the existing texture in VRAM. For textures that change every frame.
+	void updateFromPixels(const unsigned char* dataRGBA, size_t width, size_t height);
 	virtual void initFromMemory(const char* file, size_t length);
 
 	// For scalable source images in textures we want to set the resolution to rasterize at
@@ -27,20 +34,43 @@ public:
 	virtual ~TextureResource();
 
 	bool isInitialized() const;
+	bool isLoaded() const; // false if there's nothing to draw, i.e. after a renderer reinit
 	bool isTiled() const;
 
 	const Vector2i getSize() const;
-	bool bind();
+	bool bind(GLuint* textureId = nullptr); // textureId is set to the bound texture
 
 	static size_t getTotalMemUsage(); // returns an approximation of total VRAM used by textures (in bytes)
+	static size_t getQueuedMemUsage(); // returns the part of the above that's still waiting in the loader queue
 	static size_t getTotalTextureSize(); // returns the number of bytes that would be used if all textures were in memory
+	static void waitForLoads() { sTextureDataManager.waitForLoads(); } // blocks until the loader queue is done
+
+	struct PrefetchStats
+	{
+		unsigned int requested; // prefetches queued
+		unsigned int hits; // used and already decoded
+		unsigned int late; // used before the loader got to it, or after it was evicted again
+		unsigned int unused; // dropped without being used
+	};
+	static const PrefetchStats& getPrefetchStats() { return sPrefetchStats; }
+
+	// hits and misses of the VRAM and RAM tiers of the texture cache
+	static const TextureDataManager::TierStats& getVRAMStats() { return sTextureDataManager.getVRAMStats(); }
+	static const TextureDataManager::TierStats& getRAMStats() { return sTextureDataManager.getRAMStats(); }
 
 protected:
-	TextureResource(const std::string& path, bool tile, bool dynamic);
+	TextureResource(const std::string& path, bool tile, bool dynamic, const Vector2i& displaySize = Vector2i::Zero(), bool prefetch = false, TextureLoadPriority prefetchPriority = TEXTURE_LOAD_PREFETCH);
 	virtual void unload(std::shared_ptr<ResourceManager>& rm);
 	virtual void reload(std::shared_ptr<ResourceManager>& rm);
 
 private:
+	void claimPrefetched();
+
+	// The display size a texture of path is loaded for, zero if it's loaded at full size anyway so every size shares it
+	static Vector2i getTextureDisplaySize(const std::string& path, bool tile, const Vector2i& displaySize);
+	// Once the source size of tex is known, later requests for path at any size it isn't scaled down for share it
+	static void addSourceSize(const std::shared_ptr<TextureResource>& tex, const std::string& path, bool tile);
+
 	// mTextureData is used for textures that are not loaded from a file - these ones
 	// are permanently allocated and cannot be loaded and unloaded based on resources
 	std::shared_ptr<TextureData>		mTextureData;
@@ -51,10 +81,13 @@ private:
 	Vector2i					mSize;
 	Vector2f					mSourceSize;
 	bool							mForceLoad;
+	bool							mPrefetched; // queued by prefetch() and not yet returned by get()
 
-	typedef std::pair<std::string, bool> TextureKeyType;
+	typedef std::tuple<std::string, bool, int, int> TextureKeyType; // path, tile and display size
 	static std::map< TextureKeyType, std::weak_ptr<TextureResource> > sTextureMap; // map of textures, used to prevent duplicate textures
 	static std::set<TextureResource*> 	sAllTextures;	// Set of all textures, used for memory management
+	static PrefetchStats				sPrefetchStats;
+	static std::map<std::string, Vector2i>	sSourceSizes; // of the images loaded so far
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_RESOURCE_H
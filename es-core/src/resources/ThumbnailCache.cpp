@@ -0,0 +1,223 @@
+#include "resources/ThumbnailCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/ThreadPool.h"
+#include "Log.h"
+#include "Settings.h"
+#include <SDL_timer.h>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <time.h>
+
+namespace ThumbnailCache
+{
+	// bump this whenever the layout written by save() changes
+	static const long long CACHE_VERSION = 1;
+	static const char      CACHE_MAGIC[] = "ESTHUMB";
+
+	// Every file in the cache folder, only touched on the writer thread. It's listed by the first write of a run,
+	// a file counts as used when it was written or, during the run, loaded.
+	struct CacheFile
+	{
+		time_t lastUsed;
+		size_t size;
+	};
+	static std::map<std::string, CacheFile>	sFiles;
+	static size_t							sTotalSize = 0;
+	static bool								sListed = false;
+
+	// a single writer keeps the disk traffic out of the way of the texture loaders, anything it didn't get to is dropped on exit
+	static Utils::ThreadPool& getWriter()
+	{
+		static Utils::ThreadPool writer(1);
+		return writer;
+	}
+
+	static std::string getCacheFolder()
+	{
+		// generic, so the paths made from it match the ones the folder listing returns
+		return Utils::FileSystem::getGenericPath(Utils::FileSystem::getHomePath() + "/.emulationstation/cache/thumbnails");
+	}
+
+	static void writeInt(std::ostream& stream, long long value)
+	{
+		stream.write((const char*)&value, sizeof(value));
+	}
+
+	static long long readInt(std::istream& stream)
+	{
+		long long value = 0;
+		stream.read((char*)&value, sizeof(value));
+		return value;
+	}
+
+	// the header identifies the image and its state when the thumbnail was made, the pixels follow it
+	static void writeHeader(std::ostream& stream, const std::string& path, size_t displayWidth, size_t displayHeight)
+	{
+		stream.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+		writeInt(stream, CACHE_VERSION);
+		writeInt(stream, (long long)path.size());
+		stream.write(path.data(), path.size());
+		writeInt(stream, (long long)Utils::FileSystem::getModificationTime(path));
+		writeInt(stream, (long long)Utils::FileSystem::getFileSize(path));
+		writeInt(stream, (long long)displayWidth);
+		writeInt(stream, (long long)displayHeight);
+	}
+
+	std::string getCachePath(const std::string& path, size_t displayWidth, size_t displayHeight)
+	{
+		std::stringstream ss;
+		ss << getCacheFolder() << "/" << std::hex << std::hash<std::string>()(path) <<
+			std::dec << "_" << displayWidth << "x" << displayHeight << ".bin";
+		return ss.str();
+	}
+
+	static void listFiles()
+	{
+		if(sListed)
+			return;
+
+		Utils::FileSystem::stringList content = Utils::FileSystem::getDirContent(getCacheFolder());
+		for(auto it = content.cbegin(); it != content.cend(); it++)
+		{
+			if(Utils::FileSystem::getExtension(*it) != ".bin")
+				continue;
+
+			CacheFile& cacheFile = sFiles[*it];
+			cacheFile.lastUsed = Utils::FileSystem::getModificationTime(*it);
+			cacheFile.size = Utils::FileSystem::getFileSize(*it);
+			sTotalSize += cacheFile.size;
+		}
+
+		sListed = true;
+	}
+
+	static void removeCacheFile(const std::string& cachePath)
+	{
+		Utils::FileSystem::removeFile(cachePath);
+
+		auto it = sFiles.find(cachePath);
+		if(it != sFiles.cend())
+		{
+			sTotalSize -= it->second.size;
+			sFiles.erase(it);
+		}
+	}
+
+	// deletes the least recently used files until the cache fits its budget again, with some room so it isn't done on every write
+	static void prune(const std::string& keep)
+	{
+		const size_t budget = (size_t)Settings::getInstance()->getInt("ThumbnailCacheSize") * 1024 * 1024;
+		if((budget == 0) || (sTotalSize <= budget))
+			return;
+
+		const unsigned int startTime = SDL_GetTicks();
+		const size_t countBefore = sFiles.size();
+
+		std::multimap<time_t, std::string> byAge;
+		for(auto it = sFiles.cbegin(); it != sFiles.cend(); it++)
+		{
+			if(it->first != keep)
+				byAge.insert(std::make_pair(it->second.lastUsed, it->first));
+		}
+
+		for(auto it = byAge.cbegin(); (it != byAge.cend()) && (sTotalSize > budget / 10 * 9); it++)
+			removeCacheFile(it->second);
+
+		LOG(LogInfo) << "Removed " << (countBefore - sFiles.size()) << " thumbnails from the cache in " << (SDL_GetTicks() - startTime) << "ms";
+	}
+
+	bool load(const std::string& path, size_t displayWidth, size_t displayHeight, Thumbnail& thumbnail)
+	{
+		const std::string cachePath = getCachePath(path, displayWidth, displayHeight);
+		std::ifstream file(cachePath.c_str(), std::ios::in | std::ios::binary);
+		if(!file.is_open())
+			return false;
+
+		// the stored header has to match the one we'd write for the image as it is now
+		std::stringstream expected;
+		writeHeader(expected, path, displayWidth, displayHeight);
+		const std::string header = expected.str();
+
+		// the image was replaced or changed (or it's another image with the same path hash), the file is no use anymore.
+		// It's deleted on the writer thread so it can't race a write of the same file.
+		bool valid = false;
+		std::string stored(header.size(), '\0');
+		file.read(&stored[0], stored.size());
+		if(!file.fail() && stored == header)
+		{
+			thumbnail.width = (size_t)readInt(file);
+			thumbnail.height = (size_t)readInt(file);
+			thumbnail.sourceWidth = (size_t)readInt(file);
+			thumbnail.sourceHeight = (size_t)readInt(file);
+			if(!file.fail() && thumbnail.width && thumbnail.height && thumbnail.width <= thumbnail.sourceWidth && thumbnail.height <= thumbnail.sourceHeight)
+			{
+				thumbnail.dataRGBA.resize(thumbnail.width * thumbnail.height * 4);
+				file.read((char*)thumbnail.dataRGBA.data(), thumbnail.dataRGBA.size());
+				valid = !file.fail();
+			}
+		}
+		file.close();
+
+		if(!valid)
+		{
+			thumbnail.dataRGBA.clear();
+			getWriter().queueWorkItem([cachePath] { listFiles(); removeCacheFile(cachePath); });
+			return false;
+		}
+
+		// only kept for the running session, across sessions it's the time it was written
+		getWriter().queueWorkItem([cachePath]
+		{
+			auto it = sFiles.find(cachePath);
+			if(it != sFiles.cend())
+				it->second.lastUsed = time(NULL);
+		});
+
+		return true;
+	}
+
+	static void write(const std::string& path, size_t displayWidth, size_t displayHeight, const std::shared_ptr<Thumbnail>& thumbnail)
+	{
+		const std::string cachePath = getCachePath(path, displayWidth, displayHeight);
+		const std::string tempPath = cachePath + ".tmp";
+		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(cachePath));
+
+		std::ofstream file(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		writeHeader(file, path, displayWidth, displayHeight);
+		writeInt(file, (long long)thumbnail->width);
+		writeInt(file, (long long)thumbnail->height);
+		writeInt(file, (long long)thumbnail->sourceWidth);
+		writeInt(file, (long long)thumbnail->sourceHeight);
+		file.write((const char*)thumbnail->dataRGBA.data(), thumbnail->dataRGBA.size());
+		file.close();
+
+		if(file.fail() || !Utils::FileSystem::renameFile(tempPath, cachePath))
+		{
+			LOG(LogError) << "Error writing thumbnail cache \"" << cachePath << "\" (for image " << path << ")!";
+			Utils::FileSystem::removeFile(tempPath);
+			return;
+		}
+
+		// it may have replaced a file of the same name, i.e. a thumbnail of an older version of the image
+		listFiles();
+		auto it = sFiles.find(cachePath);
+		if(it != sFiles.cend())
+			sTotalSize -= it->second.size;
+
+		const CacheFile cacheFile = { time(NULL), Utils::FileSystem::getFileSize(cachePath) };
+		sFiles[cachePath] = cacheFile;
+		sTotalSize += cacheFile.size;
+
+		prune(cachePath);
+	}
+
+	void save(const std::string& path, size_t displayWidth, size_t displayHeight, const Thumbnail& thumbnail)
+	{
+		std::shared_ptr<Thumbnail> copy = std::make_shared<Thumbnail>(thumbnail);
+		getWriter().queueWorkItem([path, displayWidth, displayHeight, copy] { write(path, displayWidth, displayHeight, copy); });
+	}
+
+} // ThumbnailCache::
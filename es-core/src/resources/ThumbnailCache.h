@@ -0,0 +1,27 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_THUMBNAIL_CACHE_H
+#define ES_CORE_RESOURCES_THUMBNAIL_CACHE_H
+
+#include <string>
+#include <vector>
+
+// Keeps scaled down copies of large images on disk so they don't have to be decoded and scaled every time
+// they're shown. Entries are keyed by the image's path and the size it was scaled for, and are deleted
+// once the image's modification time or size changes. The cache is kept within the ThumbnailCacheSize setting.
+namespace ThumbnailCache
+{
+	struct Thumbnail
+	{
+		std::vector<unsigned char> dataRGBA;
+		size_t width;
+		size_t height;
+		size_t sourceWidth;
+		size_t sourceHeight;
+	};
+
+	bool load(const std::string& path, size_t displayWidth, size_t displayHeight, Thumbnail& thumbnail);
+	void save(const std::string& path, size_t displayWidth, size_t displayHeight, const Thumbnail& thumbnail); // written on a background thread
+	std::string getCachePath(const std::string& path, size_t displayWidth, size_t displayHeight);
+}
+
+#endif // ES_CORE_RESOURCES_THUMBNAIL_CACHE_H
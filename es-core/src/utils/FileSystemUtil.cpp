@@ -2,6 +2,7 @@
 
 #include "Settings.h"
 #include <sys/stat.h>
+#include <stdio.h>
 #include <string.h>
 
 #if defined(_WIN32)
@@ -501,6 +502,26 @@ namespace Utils
 
 		} // resolveSymlink
 
+		time_t getModificationTime(const std::string& _path)
+		{
+			std::string path = getGenericPath(_path);
+			struct stat info;
+
+			// return 0 if stat fails
+			return ((stat(path.c_str(), &info) == 0) ? info.st_mtime : 0);
+
+		} // getModificationTime
+
+		size_t getFileSize(const std::string& _path)
+		{
+			std::string path = getGenericPath(_path);
+			struct stat info;
+
+			// return 0 if stat fails
+			return ((stat(path.c_str(), &info) == 0) ? (size_t)info.st_size : 0);
+
+		} // getFileSize
+
 		bool removeFile(const std::string& _path)
 		{
 			std::string path = getGenericPath(_path);
@@ -514,6 +535,21 @@ namespace Utils
 
 		} // removeFile
 
+		bool renameFile(const std::string& _from, const std::string& _to)
+		{
+			std::string from = getGenericPath(_from);
+			std::string to   = getGenericPath(_to);
+
+#if defined(_WIN32)
+			// rename won't replace an existing file on windows
+			return (MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+#else // _WIN32
+			// rename replaces the destination atomically
+			return (rename(from.c_str(), to.c_str()) == 0);
+#endif // _WIN32
+
+		} // renameFile
+
 		bool createDirectory(const std::string& _path)
 		{
 			std::string path = getGenericPath(_path);
@@ -4,6 +4,7 @@
 
 #include <list>
 #include <string>
+#include <time.h>
 
 namespace Utils
 {
@@ -28,7 +29,10 @@ namespace Utils
 		std::string createRelativePath (const std::string& _path, const std::string& _relativeTo, const bool _allowHome);
 		std::string removeCommonPath   (const std::string& _path, const std::string& _common, bool& _contains);
 		std::string resolveSymlink     (const std::string& _path);
+		time_t      getModificationTime(const std::string& _path);
+		size_t      getFileSize        (const std::string& _path);
 		bool        removeFile         (const std::string& _path);
+		bool        renameFile         (const std::string& _from, const std::string& _to);
 		bool        createDirectory    (const std::string& _path);
 		bool        exists             (const std::string& _path);
 		bool        isAbsolute         (const std::string& _path);
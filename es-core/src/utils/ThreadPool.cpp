@@ -0,0 +1,103 @@
+#include "utils/ThreadPool.h"
+
+#include <chrono>
+
+namespace Utils
+{
+	ThreadPool::ThreadPool(const int _threadCount) : mPending(0), mExit(false)
+	{
+		const int threadCount = (_threadCount > 0) ? _threadCount : getHardwareThreadCount();
+
+		for(int i = 0; i < threadCount; ++i)
+			mThreads.push_back(new std::thread(&ThreadPool::threadProc, this));
+
+	} // ThreadPool::ThreadPool
+
+	ThreadPool::~ThreadPool()
+	{
+		// abort anything that hasn't been picked up yet, running items are allowed to finish
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mPending -= (int)mWorkQueue.size();
+			mWorkQueue.clear();
+			mExit = true;
+		}
+		mEvent.notify_all();
+
+		for(auto it = mThreads.cbegin(); it != mThreads.cend(); ++it)
+		{
+			(*it)->join();
+			delete *it;
+		}
+
+	} // ThreadPool::~ThreadPool
+
+	void ThreadPool::queueWorkItem(work_function _work)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWorkQueue.push_back(_work);
+			++mPending;
+		}
+		mEvent.notify_one();
+
+	} // ThreadPool::queueWorkItem
+
+	void ThreadPool::wait()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDoneEvent.wait(lock, [this] { return mPending == 0; });
+
+	} // ThreadPool::wait
+
+	void ThreadPool::wait(work_function _waitFunction, const int _delay)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		while(mPending > 0)
+		{
+			mDoneEvent.wait_for(lock, std::chrono::milliseconds(_delay));
+
+			// run the callback without holding the lock so the workers can keep going
+			lock.unlock();
+			_waitFunction();
+			lock.lock();
+		}
+
+	} // ThreadPool::wait
+
+	int ThreadPool::getHardwareThreadCount()
+	{
+		// hardware_concurrency is allowed to return 0 when it can't be determined
+		const int count = (int)std::thread::hardware_concurrency();
+		return (count > 0) ? count : 1;
+
+	} // ThreadPool::getHardwareThreadCount
+
+	void ThreadPool::threadProc()
+	{
+		while(true)
+		{
+			work_function work;
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mEvent.wait(lock, [this] { return mExit || !mWorkQueue.empty(); });
+
+				if(mExit)
+					return;
+
+				work = mWorkQueue.front();
+				mWorkQueue.pop_front();
+			}
+
+			work();
+
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				--mPending;
+			}
+			mDoneEvent.notify_all();
+		}
+
+	} // ThreadPool::threadProc
+
+} // Utils::
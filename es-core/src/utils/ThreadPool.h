@@ -0,0 +1,51 @@
+#pragma once
+#ifndef ES_CORE_UTILS_THREAD_POOL_H
+#define ES_CORE_UTILS_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+	// A fixed set of worker threads consuming a FIFO queue of work items
+	class ThreadPool
+	{
+	public:
+		typedef std::function<void()> work_function;
+
+		// a thread count of 0 (or less) uses one thread per hardware core
+		ThreadPool(const int _threadCount = 0);
+		~ThreadPool();
+
+		void queueWorkItem(work_function _work);
+
+		// block until every queued work item has completed
+		void wait();
+		// as above, but call _waitFunction on the calling thread every time a work item
+		// completes or _delay milliseconds pass, whichever comes first
+		void wait(work_function _waitFunction, const int _delay);
+
+		inline int getThreadCount() const { return (int)mThreads.size(); }
+
+		static int getHardwareThreadCount();
+
+	private:
+		void threadProc();
+
+		std::vector<std::thread*>	mThreads;
+		std::list<work_function>	mWorkQueue;
+		std::mutex					mMutex;
+		std::condition_variable		mEvent;
+		std::condition_variable		mDoneEvent;
+		int							mPending;
+		bool						mExit;
+
+	}; // ThreadPool
+
+} // Utils::
+
+#endif // ES_CORE_UTILS_THREAD_POOL_H